@@ -0,0 +1,641 @@
+/*
+ * Per-Node locked variant of LinkedList, see ConcurrentList.h
+ *
+ * The list always starts and ends with a sentinel Node, so every linked Node
+ * has a prev and a next to lock and no operation ever touches clist itself
+ * (but for the Node count).
+ *
+ * Locks are only ever taken in list order (prev before next), and a thread
+ * never holds a lock while waiting for the one of a Node before it: to lock
+ * prev, it unlocks node, locks prev, locks node again and checks that they are
+ * still linked together.
+ *
+ * Refcounts: a linked Node holds one reference for the list, plus one per
+ * cursor on it. Unlinking a Node freezes its prev and next, which it then
+ * references until it is freed, so cursors can always move on from it.
+ * A Node's neighbour is only referenced while holding that Node's lock.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "ConcurrentList.h"
+#include "LlistAtomic.h"
+
+
+struct CNode {
+	struct CNode *prev;
+	struct CNode *next;
+	void *data;
+	pthread_mutex_t lock;
+	size_t refCount;
+	int b_removed;
+
+	/* Set by clist_removeNode, the data is destroyed when the last cursor lets go */
+	nodeDestroyFunc f_destroyOnFree;
+};
+
+
+struct s_ConcurrentList {
+	struct CNode head;
+	struct CNode tail;
+	size_t nbNodes;
+	nodeDestroyFunc f_destroyNode;
+	nodeCmpFunc f_cmpNode;
+};
+
+
+struct s_ClistCursor {
+	struct CNode *node;
+};
+
+
+
+/* === Internal functions === */
+static int
+initNode(struct CNode *node, void *data) {
+	node->prev = node->next = NULL;
+	node->data = data;
+	node->refCount = 1;
+	node->b_removed = 0;
+	node->f_destroyOnFree = NULL;
+
+	return pthread_mutex_init(&(node->lock), NULL);
+}
+
+
+static struct CNode *
+new_cnode(void *data) {
+	struct CNode *node = malloc(sizeof (*node));
+
+	if (node != NULL && initNode(node, data) != 0) {
+		free(node), node = NULL;
+	}
+
+	return node;
+}
+
+
+/* Doesn't look at the refCount, see unrefNode */
+static void
+freeNode(struct CNode *node) {
+	pthread_mutex_destroy(&(node->lock));
+	free(node);
+}
+
+
+static void
+lockNode(struct CNode *node) {
+	pthread_mutex_lock(&(node->lock));
+}
+
+
+static void
+unlockNode(struct CNode *node) {
+	pthread_mutex_unlock(&(node->lock));
+}
+
+
+static void
+refNode(struct CNode *node) {
+	ATOMIC_FETCH_ADD_RELAXED(&(node->refCount), 1);
+}
+
+
+/* Dead Nodes get chained through their (no longer used) data to be freed */
+static void
+dropRef(struct CNode *node, struct CNode **p_dead) {
+	if (ATOMIC_FETCH_ADD(&(node->refCount), (size_t)-1) == 1) {
+		if (node->f_destroyOnFree != NULL) {
+			node->f_destroyOnFree(node->data);
+		}
+		node->data = *p_dead;
+		*p_dead = node;
+	}
+}
+
+
+/* Freeing a removed Node releases its frozen neighbours, which can cascade
+ * along a run of removed Nodes, hence the loop instead of recursion */
+static void
+unrefNode(struct CNode *node) {
+	struct CNode *dead = NULL;
+
+	dropRef(node, &dead);
+	while (dead != NULL) {
+		struct CNode *next = dead->data;
+
+		/* Sentinels never die before the list is destroyed */
+		assert(dead->b_removed);
+		dropRef(dead->prev, &next);
+		dropRef(dead->next, &next);
+
+		freeNode(dead);
+		dead = next;
+	}
+}
+
+
+static int
+isRemoved(struct CNode *node) {
+	return ATOMIC_LOAD_ACQUIRE(&(node->b_removed));
+}
+
+
+static int
+isSentinel(ConcurrentList *clist, struct CNode *node) {
+	return (node == &(clist->head) || node == &(clist->tail));
+}
+
+
+/* Returns the first Node still in the list from node in direction dir
+ * (possibly a sentinel), with a reference taken on it */
+static struct CNode *
+getNeighbour(struct CNode *node, LlistDirection dir) {
+	struct CNode *neighbour;
+
+	refNode(node);
+	do {
+		lockNode(node);
+		neighbour = (dir == LLIST_AFTER) ? node->next : node->prev;
+		refNode(neighbour);
+		unlockNode(node);
+
+		unrefNode(node);
+		node = neighbour;
+	} while (isRemoved(node));
+
+	return node;
+}
+
+
+/* Locks node and the Node before it (returned), or returns NULL without
+ * locking anything if node was removed */
+static struct CNode *
+lockWithPrev(struct CNode *node) {
+	for (;;) {
+		struct CNode *prev;
+
+		lockNode(node);
+		if (node->b_removed) {
+			unlockNode(node);
+			return NULL;
+		}
+		prev = node->prev;
+		refNode(prev);
+		unlockNode(node);
+
+		lockNode(prev);
+		lockNode(node);
+		if (!node->b_removed && node->prev == prev) {
+			/* prev stays alive: it is linked to node, which is locked */
+			unrefNode(prev);
+			return prev;
+		}
+		unlockNode(node);
+		unlockNode(prev);
+		unrefNode(prev);
+	}
+}
+
+
+/* prev and prev->next must be locked */
+static void
+linkAfter(ConcurrentList *clist, struct CNode *prev, struct CNode *node) {
+	struct CNode *next = prev->next;
+
+	node->prev = prev;
+	node->next = next;
+	prev->next = node;
+	next->prev = node;
+
+	ATOMIC_FETCH_ADD(&(clist->nbNodes), 1);
+}
+
+
+/* Unlinks node, which must not be a sentinel, with its f_destroyOnFree set to
+ * f_destroyNode. Returns 0 and its data in *p_data, or -1 if node was already removed */
+static int
+unlinkNode(ConcurrentList *clist, struct CNode *node, nodeDestroyFunc f_destroyNode, void **p_data) {
+	struct CNode *prev, *next;
+
+	prev = lockWithPrev(node);
+	if (prev == NULL) {
+		return -1;
+	}
+	next = node->next;
+	lockNode(next);
+
+	prev->next = next;
+	next->prev = prev;
+
+	/* node->prev and node->next are now frozen */
+	refNode(prev);
+	refNode(next);
+	*p_data = node->data;
+	node->f_destroyOnFree = f_destroyNode;
+	ATOMIC_STORE_RELEASE(&(node->b_removed), 1);
+
+	unlockNode(next);
+	unlockNode(node);
+	unlockNode(prev);
+
+	ATOMIC_FETCH_ADD(&(clist->nbNodes), (size_t)-1);
+
+	/* The list's reference, the caller's cursor still holds one */
+	unrefNode(node);
+
+	return 0;
+}
+
+
+/* Moves cursor to node, whose reference it takes over */
+static void
+setCursor(ClistCursor *cursor, struct CNode *node) {
+	if (cursor->node != NULL) {
+		unrefNode(cursor->node);
+	}
+	cursor->node = node;
+}
+
+/* === END Internal functions === */
+
+
+
+ConcurrentList *
+clist_new(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode) {
+	ConcurrentList *clist = malloc(sizeof (*clist));
+
+	if (clist == NULL) {
+		return NULL;
+	}
+
+	if (initNode(&(clist->head), NULL) != 0) {
+		free(clist);
+		return NULL;
+	}
+	if (initNode(&(clist->tail), NULL) != 0) {
+		pthread_mutex_destroy(&(clist->head.lock));
+		free(clist);
+		return NULL;
+	}
+	clist->head.next = &(clist->tail);
+	clist->tail.prev = &(clist->head);
+
+	clist->nbNodes = 0;
+	clist->f_destroyNode = f_destroyNode;
+	clist->f_cmpNode = f_cmpNode;
+
+	return clist;
+}
+
+
+/* Not thread-safe, and every cursor must have been destroyed */
+int
+clist_destroy(ConcurrentList **p_clist) {
+	ConcurrentList *clist;
+	struct CNode *node;
+	int error = 0;
+
+	if (p_clist == NULL || *p_clist == NULL) {
+		return 0;
+	}
+	clist = *p_clist;
+
+	node = clist->head.next;
+	while (node != &(clist->tail)) {
+		struct CNode *next = node->next;
+
+		assert(node->refCount == 1);
+		if (clist->f_destroyNode != NULL) {
+			int destroyCode = clist->f_destroyNode(node->data);
+
+			if (destroyCode != 0) {
+				error = destroyCode;
+			}
+		}
+		freeNode(node);
+		node = next;
+	}
+
+	pthread_mutex_destroy(&(clist->head.lock));
+	pthread_mutex_destroy(&(clist->tail.lock));
+	free(clist), *p_clist = NULL;
+
+	return error;
+}
+
+
+ClistCursor *
+clistCursor_new(void) {
+	ClistCursor *cursor = malloc(sizeof (*cursor));
+
+	if (cursor != NULL) {
+		cursor->node = NULL;
+	}
+
+	return cursor;
+}
+
+
+/* The copy points to the same Node */
+ClistCursor *
+clistCursor_copy(ClistCursor *cursor) {
+	ClistCursor *copy;
+
+	if (cursor == NULL) {
+		return NULL;
+	}
+
+	copy = clistCursor_new();
+	if (copy != NULL && cursor->node != NULL) {
+		refNode(cursor->node);
+		copy->node = cursor->node;
+	}
+	return copy;
+}
+
+
+int
+clistCursor_destroy(ClistCursor **p_cursor) {
+	if (p_cursor == NULL || *p_cursor == NULL) {
+		return 0;
+	}
+
+	setCursor(*p_cursor, NULL);
+	free(*p_cursor), *p_cursor = NULL;
+
+	return 0;
+}
+
+
+/* Only a snapshot when other threads are using the list */
+size_t
+clist_size(ConcurrentList *clist) {
+	return ATOMIC_LOAD(&(clist->nbNodes));
+}
+
+
+/* Returns 0 on success, -1 if the list is empty, -2 for an invalid cursor */
+int
+clistCursor_getHead(ConcurrentList *clist, ClistCursor *cursor) {
+	struct CNode *node;
+
+	if (cursor == NULL) {
+		return -2;
+	}
+
+	node = getNeighbour(&(clist->head), LLIST_AFTER);
+	if (node == &(clist->tail)) {
+		unrefNode(node);
+		return -1;
+	}
+
+	setCursor(cursor, node);
+	return 0;
+}
+
+
+/* Returns 0 on success, -1 if the list is empty, -2 for an invalid cursor */
+int
+clistCursor_getTail(ConcurrentList *clist, ClistCursor *cursor) {
+	struct CNode *node;
+
+	if (cursor == NULL) {
+		return -2;
+	}
+
+	node = getNeighbour(&(clist->tail), LLIST_BEFORE);
+	if (node == &(clist->head)) {
+		unrefNode(node);
+		return -1;
+	}
+
+	setCursor(cursor, node);
+	return 0;
+}
+
+
+/* Moves to the next Node still in the list, even if the cursor's Node was removed
+ * Returns 0 on success, -1 at the end of the list, -2 for an invalid cursor
+ */
+int
+clistCursor_getNext(ConcurrentList *clist, ClistCursor *cursor) {
+	struct CNode *node;
+
+	if (cursor == NULL || cursor->node == NULL) {
+		return -2;
+	}
+
+	node = getNeighbour(cursor->node, LLIST_AFTER);
+	if (isSentinel(clist, node)) {
+		unrefNode(node);
+		return -1;
+	}
+
+	setCursor(cursor, node);
+	return 0;
+}
+
+
+/* Moves to the previous Node still in the list, even if the cursor's Node was removed
+ * Returns 0 on success, -1 at the start of the list, -2 for an invalid cursor
+ */
+int
+clistCursor_getPrev(ConcurrentList *clist, ClistCursor *cursor) {
+	struct CNode *node;
+
+	if (cursor == NULL || cursor->node == NULL) {
+		return -2;
+	}
+
+	node = getNeighbour(cursor->node, LLIST_BEFORE);
+	if (isSentinel(clist, node)) {
+		unrefNode(node);
+		return -1;
+	}
+
+	setCursor(cursor, node);
+	return 0;
+}
+
+
+/* The data of a Node removed by clist_popNode belongs to whoever popped it */
+void *
+clistCursor_getData(ConcurrentList *clist, ClistCursor *cursor) {
+	(void)clist;
+
+	if (cursor == NULL || cursor->node == NULL) {
+		return NULL;
+	}
+	return cursor->node->data;
+}
+
+
+/* Returns 1 if the cursor's Node was removed from the list, 0 if it wasn't,
+ * -2 for an invalid cursor */
+int
+clistCursor_isRemoved(ConcurrentList *clist, ClistCursor *cursor) {
+	(void)clist;
+
+	if (cursor == NULL || cursor->node == NULL) {
+		return -2;
+	}
+	return isRemoved(cursor->node);
+}
+
+
+/* Moves to the next Node whose data matches (f_cmpNode(data, nodeData) == 0)
+ * Returns 0 on success, -1 if there is none (the cursor doesn't move),
+ * -2 for an invalid cursor
+ */
+int
+clistCursor_findNext(ConcurrentList *clist, ClistCursor *cursor, void *data) {
+	struct CNode *node;
+
+	if (cursor == NULL || cursor->node == NULL) {
+		return -2;
+	}
+
+	node = getNeighbour(cursor->node, LLIST_AFTER);
+	while (!isSentinel(clist, node)) {
+		struct CNode *next;
+
+		if (0 == clist->f_cmpNode(data, node->data)) {
+			setCursor(cursor, node);
+			return 0;
+		}
+
+		next = getNeighbour(node, LLIST_AFTER);
+		unrefNode(node);
+		node = next;
+	}
+
+	unrefNode(node);
+	return -1;
+}
+
+
+/* Returns 0 on success, negative number on failure */
+int
+clist_insertHead(ConcurrentList *clist, void *data) {
+	struct CNode *newNode = new_cnode(data);
+
+	if (newNode == NULL) {
+		return -1;
+	}
+
+	lockNode(&(clist->head));
+	lockNode(clist->head.next);
+	linkAfter(clist, &(clist->head), newNode);
+	unlockNode(newNode->next);
+	unlockNode(&(clist->head));
+
+	return 0;
+}
+
+
+/* Returns 0 on success, negative number on failure */
+int
+clist_insertTail(ConcurrentList *clist, void *data) {
+	struct CNode *newNode = new_cnode(data);
+	struct CNode *prev;
+
+	if (newNode == NULL) {
+		return -1;
+	}
+
+	prev = lockWithPrev(&(clist->tail));
+	assert(prev != NULL);
+	linkAfter(clist, prev, newNode);
+	unlockNode(&(clist->tail));
+	unlockNode(prev);
+
+	return 0;
+}
+
+
+/* Returns 0 on success, negative number on failure
+ * (-3 if the cursor's Node was removed, so there is nothing to insert next to)
+ */
+int
+clistCursor_insertData(ConcurrentList *clist, ClistCursor *cursor, void *data, LlistDirection dir) {
+	struct CNode *node, *prev, *newNode;
+
+	if (cursor == NULL || cursor->node == NULL) {
+		return -2;
+	}
+	if (dir != LLIST_BEFORE && dir != LLIST_AFTER) {
+		return -1;
+	}
+	node = cursor->node;
+
+	newNode = new_cnode(data);
+	if (newNode == NULL) {
+		return -1;
+	}
+
+	if (dir == LLIST_BEFORE) {
+		prev = lockWithPrev(node);
+		if (prev == NULL) {
+			freeNode(newNode);
+			return -3;
+		}
+		linkAfter(clist, prev, newNode);
+		unlockNode(node);
+		unlockNode(prev);
+
+	} else {
+		lockNode(node);
+		if (node->b_removed) {
+			unlockNode(node);
+			freeNode(newNode);
+			return -3;
+		}
+		lockNode(node->next);
+		linkAfter(clist, node, newNode);
+		unlockNode(newNode->next);
+		unlockNode(node);
+	}
+
+	return 0;
+}
+
+
+/* Unlinks the cursor's Node, the cursor stays on it and can still move on
+ * Returns NULL if it was already removed
+ * Caller is responsible of freeing the data returned
+ */
+void *
+clist_popNode(ConcurrentList *clist, ClistCursor *cursor) {
+	void *data;
+
+	if (cursor == NULL || cursor->node == NULL) {
+		return NULL;
+	}
+	if (unlinkNode(clist, cursor->node, NULL, &data) != 0) {
+		return NULL;
+	}
+
+	return data;
+}
+
+
+/* Same as clist_popNode, but the data is destroyed once no cursor is left on
+ * the Node. Returns 0 on success, -1 for an invalid cursor, -3 if the Node
+ * was already removed
+ */
+int
+clist_removeNode(ConcurrentList *clist, ClistCursor *cursor) {
+	void *data;
+
+	if (cursor == NULL || cursor->node == NULL) {
+		return -1;
+	}
+	if (unlinkNode(clist, cursor->node, clist->f_destroyNode, &data) != 0) {
+		return -3;
+	}
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Thread-safe variant of LinkedList for threads walking the list with cursors
+ * and inserting or removing in the middle of it at the same time.
+ *
+ * Every Node has its own lock and operations only lock the Nodes they link or
+ * unlink (always in list order), so threads working on disjoint regions of the
+ * list never wait for each other. Nodes are refcounted: a cursor keeps its Node
+ * alive, and a removed Node keeps the neighbours it had, so a cursor left on a
+ * Node which another thread removed can still move on from it.
+ *
+ * clist_new and clist_destroy are not thread-safe, and every cursor must be
+ * destroyed before the list is.
+ */
+
+#ifndef CONCURRENT_LIST_H
+#define CONCURRENT_LIST_H
+
+#include <stdlib.h> /* size_t */
+
+#include "LinkedList.h" /* nodeDestroyFunc, nodeCmpFunc, LlistDirection */
+
+
+/* Forward declare and typedef internal structs (since callers shouldn't know the internals) */
+typedef struct s_ConcurrentList ConcurrentList;
+typedef struct s_ClistCursor ClistCursor;
+
+
+
+/* === ctor/dtor === */
+
+ConcurrentList *
+clist_new(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode);
+
+
+int
+clist_destroy(ConcurrentList **p_clist);
+
+
+ClistCursor *
+clistCursor_new(void);
+
+
+ClistCursor *
+clistCursor_copy(ClistCursor *cursor);
+
+
+int
+clistCursor_destroy(ClistCursor **p_cursor);
+
+/* === END ctor/dtor === */
+
+
+
+/* === Query functions === */
+
+size_t
+clist_size(ConcurrentList *clist);
+
+/* === END Query functions === */
+
+
+
+/* === Cursor functions === */
+
+int
+clistCursor_getHead(ConcurrentList *clist, ClistCursor *cursor);
+
+int
+clistCursor_getTail(ConcurrentList *clist, ClistCursor *cursor);
+
+int
+clistCursor_getNext(ConcurrentList *clist, ClistCursor *cursor);
+
+int
+clistCursor_getPrev(ConcurrentList *clist, ClistCursor *cursor);
+
+void *
+clistCursor_getData(ConcurrentList *clist, ClistCursor *cursor);
+
+int
+clistCursor_isRemoved(ConcurrentList *clist, ClistCursor *cursor);
+
+int
+clistCursor_findNext(ConcurrentList *clist, ClistCursor *cursor, void *data);
+
+/* === END Cursor functions === */
+
+
+
+/* === Insert functions === */
+
+int
+clist_insertHead(ConcurrentList *clist, void *data);
+
+int
+clist_insertTail(ConcurrentList *clist, void *data);
+
+int
+clistCursor_insertData(ConcurrentList *clist, ClistCursor *cursor, void *data, LlistDirection dir);
+
+/* === END Insert functions === */
+
+
+
+/* === Delete functions === */
+
+void *
+clist_popNode(ConcurrentList *clist, ClistCursor *cursor);
+
+int
+clist_removeNode(ConcurrentList *clist, ClistCursor *cursor);
+
+/* === END Delete functions === */
+
+#endif /* Guard */
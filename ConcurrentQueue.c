@@ -0,0 +1,581 @@
+/*
+ * Lock-free queue, see ConcurrentQueue.h
+ *
+ * This is the Michael-Scott queue: head always points to a dummy Node whose
+ * successor holds the first data, producers CAS new Nodes after the tail and
+ * consumers CAS the head forward. Threads help each other move a lagging tail.
+ *
+ * Each thread owns a HazardRecord per queue it uses, in which it publishes the
+ * Nodes it is about to dereference. Popped Nodes are retired to the thread's
+ * record and only freed once no record points to them anymore. Records are
+ * taken on a thread's first operation on a queue and kept in a thread-local
+ * list, so operations don't touch any shared word besides the queue's own.
+ * They are given back when the thread exits, for other threads to take.
+ */
+
+#include <stdlib.h>
+#include <string.h> /* memcpy */
+#include <pthread.h>
+
+#include "ConcurrentQueue.h"
+#include "LlistAtomic.h"
+
+
+#define CQUEUE_CACHE_LINE 64
+#define CQUEUE_HAZARDS 2
+
+/* HazardRecord states */
+#define CQUEUE_RECORD_FREE 0
+#define CQUEUE_RECORD_OWNED 1
+#define CQUEUE_RECORD_ORPHANED 2
+
+
+struct QNode {
+	struct QNode *next;
+	void *data;
+};
+
+
+/*
+ * Records are never freed before the queue, so the list of records only grows.
+ * A record is free, owned by a thread, or orphaned when its queue got destroyed
+ * while a thread still owned it: that thread then frees it (with its copy of
+ * the queue's allocator) the next time it looks for a record, or when it exits.
+ */
+struct HazardRecord {
+	struct HazardRecord *next;
+	int state;
+	struct QNode *hazards[CQUEUE_HAZARDS];
+
+	/* Only touched by the thread owning the record */
+	ConcurrentQueue *queue;
+	struct HazardRecord *threadNext;
+	LlistAllocator allocator;
+	struct QNode **retired;
+	size_t nbRetired;
+	size_t retiredCapacity;
+
+	/* Records of different threads don't share a cache line */
+	char pad[CQUEUE_CACHE_LINE];
+};
+
+
+/* head and tail get their own cache lines so producers and consumers don't fight over one */
+struct s_ConcurrentQueue {
+	struct QNode *head;
+	char headPad[CQUEUE_CACHE_LINE - sizeof (struct QNode *)];
+	struct QNode *tail;
+	char tailPad[CQUEUE_CACHE_LINE - sizeof (struct QNode *)];
+
+	struct HazardRecord *records;
+	size_t nbRecords;
+	nodeDestroyFunc f_destroyNode;
+	LlistAllocator allocator;
+};
+
+
+/* Records owned by the calling thread, for all queues (GCC extension, like
+ * the atomics of LlistAtomic.h). threadKey's destructor gives them back when
+ * the thread exits, if it could be created (they stay owned otherwise) */
+static __thread struct HazardRecord *threadRecords = NULL;
+static pthread_key_t threadKey;
+static pthread_once_t threadKeyOnce = PTHREAD_ONCE_INIT;
+static int b_threadKey = 0;
+
+
+
+/* === Internal functions === */
+static void *
+defaultAlloc(void *context, size_t size) {
+	(void)context;
+	return malloc(size);
+}
+
+
+static void
+defaultFree(void *context, void *ptr) {
+	(void)context;
+	free(ptr);
+}
+
+
+static const LlistAllocator defaultAllocator = { defaultAlloc, defaultFree, NULL };
+
+
+static void *
+allocatorAlloc(const LlistAllocator *allocator, size_t size) {
+	return allocator->f_alloc(allocator->context, size);
+}
+
+
+/* f_free is NULL for arenas which release everything at once */
+static void
+allocatorFree(const LlistAllocator *allocator, void *ptr) {
+	if (allocator->f_free != NULL) {
+		allocator->f_free(allocator->context, ptr);
+	}
+}
+
+
+static struct QNode *
+new_qnode(ConcurrentQueue *queue, void *data) {
+	struct QNode *node = allocatorAlloc(&(queue->allocator), sizeof (*node));
+
+	if (node != NULL) {
+		node->next = NULL;
+		node->data = data;
+	}
+
+	return node;
+}
+
+
+/* Frees an orphaned record, its retired Nodes went with its queue */
+static void
+freeRecord(struct HazardRecord *record) {
+	LlistAllocator allocator = record->allocator;
+
+	allocatorFree(&allocator, record);
+}
+
+
+/* threadKey's destructor: frees the records of the exiting thread which got
+ * orphaned and gives the others back to their queue */
+static void
+releaseThreadRecords(void *arg) {
+	struct HazardRecord *record = arg;
+
+	while (record != NULL) {
+		struct HazardRecord *next = record->threadNext;
+		int owned = CQUEUE_RECORD_OWNED;
+
+		if (!ATOMIC_CAS(&(record->state), &owned, CQUEUE_RECORD_FREE)) {
+			freeRecord(record);
+		}
+		record = next;
+	}
+	threadRecords = NULL;
+}
+
+
+static void
+createThreadKey(void) {
+	b_threadKey = (pthread_key_create(&threadKey, releaseThreadRecords) == 0);
+}
+
+
+/* Takes a free record of queue or adds a new one, NULL on allocation failure */
+static struct HazardRecord *
+acquireRecord(ConcurrentQueue *queue) {
+	struct HazardRecord *record;
+	struct HazardRecord *head;
+	int i;
+
+	for (record = ATOMIC_LOAD(&(queue->records)); record != NULL; record = record->next) {
+		int free = CQUEUE_RECORD_FREE;
+
+		if (ATOMIC_LOAD_RELAXED(&(record->state)) == CQUEUE_RECORD_FREE
+				&& ATOMIC_CAS(&(record->state), &free, CQUEUE_RECORD_OWNED)) {
+			return record;
+		}
+	}
+
+	record = allocatorAlloc(&(queue->allocator), sizeof (*record));
+	if (record == NULL) {
+		return NULL;
+	}
+	record->state = CQUEUE_RECORD_OWNED;
+	for (i = 0; i < CQUEUE_HAZARDS; i++) {
+		record->hazards[i] = NULL;
+	}
+	record->allocator = queue->allocator;
+	record->retired = NULL;
+	record->nbRetired = 0;
+	record->retiredCapacity = 0;
+
+	head = ATOMIC_LOAD(&(queue->records));
+	do {
+		record->next = head;
+	} while (!ATOMIC_CAS(&(queue->records), &head, record));
+	ATOMIC_FETCH_ADD(&(queue->nbRecords), 1);
+
+	return record;
+}
+
+
+/* The calling thread's record for queue, taken on its first operation on it
+ * Frees the thread's orphaned records met on the way
+ */
+static struct HazardRecord *
+threadRecord(ConcurrentQueue *queue) {
+	struct HazardRecord **p_record = &threadRecords;
+	struct HazardRecord *record;
+
+	while ((record = *p_record) != NULL) {
+		if (ATOMIC_LOAD_ACQUIRE(&(record->state)) == CQUEUE_RECORD_ORPHANED) {
+			*p_record = record->threadNext;
+			freeRecord(record);
+			continue;
+		}
+		if (record->queue == queue) {
+			return record;
+		}
+		p_record = &(record->threadNext);
+	}
+
+	record = acquireRecord(queue);
+	if (record == NULL) {
+		return NULL;
+	}
+	record->queue = queue;
+	record->threadNext = threadRecords;
+	threadRecords = record;
+
+	pthread_once(&threadKeyOnce, createThreadKey);
+	if (b_threadKey) {
+		pthread_setspecific(threadKey, threadRecords);
+	}
+	return record;
+}
+
+
+/* Ends an operation: its Nodes don't need protection anymore */
+static void
+clearHazards(struct HazardRecord *record) {
+	int i;
+
+	for (i = 0; i < CQUEUE_HAZARDS; i++) {
+		ATOMIC_STORE_RELEASE(&(record->hazards[i]), (struct QNode *)NULL);
+	}
+}
+
+
+/* Publishes *p_shared in hazard slot i and returns it once it is known to
+ * still be in place (so it can't have been freed in between) */
+static struct QNode *
+protect(struct HazardRecord *record, int i, struct QNode **p_shared) {
+	struct QNode *node = ATOMIC_LOAD(p_shared);
+	struct QNode *check;
+
+	for (;;) {
+		ATOMIC_STORE(&(record->hazards[i]), node);
+		check = ATOMIC_LOAD(p_shared);
+		if (check == node) {
+			return node;
+		}
+		node = check;
+	}
+}
+
+
+static int
+cmpPointers(const void *p1, const void *p2) {
+	const char *a = *(const char * const *)p1;
+	const char *b = *(const char * const *)p2;
+
+	return (a > b) - (a < b);
+}
+
+
+/* Frees the retired Nodes of record which no hazard pointer protects
+ * (none at all if the hazards can't be gathered) */
+static void
+scanRetired(ConcurrentQueue *queue, struct HazardRecord *record) {
+	struct HazardRecord *other;
+	struct QNode **protected = NULL;
+	size_t nbProtected = 0;
+	size_t maxProtected = 0;
+	size_t i, kept = 0;
+
+	/* Records can be added during the walk (before nbRecords counts them),
+	 * so the array grows with the hazards found rather than trust nbRecords */
+	for (other = ATOMIC_LOAD(&(queue->records)); other != NULL; other = other->next) {
+		int j;
+
+		for (j = 0; j < CQUEUE_HAZARDS; j++) {
+			struct QNode *node = ATOMIC_LOAD(&(other->hazards[j]));
+
+			if (node == NULL) {
+				continue;
+			}
+			if (nbProtected == maxProtected) {
+				size_t capacity = 2 * maxProtected + (ATOMIC_LOAD(&(queue->nbRecords)) + 1) * CQUEUE_HAZARDS;
+				struct QNode **grown = allocatorAlloc(&(queue->allocator), capacity * sizeof (*grown));
+
+				if (grown == NULL) {
+					allocatorFree(&(queue->allocator), protected);
+					return;
+				}
+				if (protected != NULL) {
+					memcpy(grown, protected, nbProtected * sizeof (*grown));
+					allocatorFree(&(queue->allocator), protected);
+				}
+				protected = grown;
+				maxProtected = capacity;
+			}
+			protected[nbProtected++] = node;
+		}
+	}
+	if (nbProtected > 0) {
+		qsort(protected, nbProtected, sizeof (*protected), cmpPointers);
+	}
+
+	for (i = 0; i < record->nbRetired; i++) {
+		struct QNode *node = record->retired[i];
+
+		if (nbProtected > 0 && bsearch(&node, protected, nbProtected, sizeof (*protected), cmpPointers) != NULL) {
+			record->retired[kept++] = node;
+		} else {
+			allocatorFree(&(queue->allocator), node);
+		}
+	}
+	record->nbRetired = kept;
+
+	if (protected != NULL) {
+		allocatorFree(&(queue->allocator), protected);
+	}
+}
+
+
+static void
+retireNode(ConcurrentQueue *queue, struct HazardRecord *record, struct QNode *node) {
+	size_t threshold = 2 * CQUEUE_HAZARDS * ATOMIC_LOAD(&(queue->nbRecords)) + 16;
+
+	if (record->nbRetired == record->retiredCapacity) {
+		size_t capacity = (threshold > 2 * record->retiredCapacity) ? threshold : 2 * record->retiredCapacity;
+		struct QNode **retired = allocatorAlloc(&(queue->allocator), capacity * sizeof (*retired));
+
+		if (retired != NULL) {
+			if (record->retired != NULL) {
+				memcpy(retired, record->retired, record->nbRetired * sizeof (*retired));
+				allocatorFree(&(queue->allocator), record->retired);
+			}
+			record->retired = retired;
+			record->retiredCapacity = capacity;
+		}
+	}
+
+	/* Out of memory: only hazards can keep Nodes from being freed and there
+	 * are fewer of them than retired Nodes, so scanning makes room eventually */
+	while (record->nbRetired == record->retiredCapacity) {
+		scanRetired(queue, record);
+	}
+
+	record->retired[record->nbRetired++] = node;
+	if (record->nbRetired >= threshold) {
+		scanRetired(queue, record);
+	}
+}
+
+/* === END Internal functions === */
+
+
+
+ConcurrentQueue *
+cqueue_new(nodeDestroyFunc f_destroyNode) {
+	return cqueue_newWithAllocator(f_destroyNode, NULL);
+}
+
+
+/*
+ * cqueue_newWithAllocator
+ *
+ * Same as cqueue_new, but the queue, its Nodes and its bookkeeping are
+ * allocated with allocator (copied, NULL for malloc/free). allocator must stay
+ * usable until every thread which used the queue exited or used another queue
+ * after it got destroyed: threads free their last bits of it then.
+ */
+ConcurrentQueue *
+cqueue_newWithAllocator(nodeDestroyFunc f_destroyNode, const LlistAllocator *allocator) {
+	ConcurrentQueue *queue;
+
+	if (allocator == NULL) {
+		allocator = &defaultAllocator;
+	}
+
+	queue = allocatorAlloc(allocator, sizeof (*queue));
+	if (queue == NULL) {
+		return NULL;
+	}
+	queue->allocator = *allocator;
+
+	/* Dummy Node */
+	queue->head = queue->tail = new_qnode(queue, NULL);
+	if (queue->head == NULL) {
+		allocatorFree(allocator, queue);
+		return NULL;
+	}
+
+	queue->records = NULL;
+	queue->nbRecords = 0;
+	queue->f_destroyNode = f_destroyNode;
+
+	return queue;
+}
+
+
+/* Not thread-safe, no other thread may be using the queue */
+int
+cqueue_destroy(ConcurrentQueue **p_queue) {
+	ConcurrentQueue *queue;
+	LlistAllocator allocator;
+	struct QNode *node;
+	struct HazardRecord *record;
+	int error = 0;
+
+	if (p_queue == NULL || *p_queue == NULL) {
+		return 0;
+	}
+	queue = *p_queue;
+	allocator = queue->allocator;
+
+	/* The dummy head doesn't hold any data */
+	node = queue->head;
+	while (node != NULL) {
+		struct QNode *next = node->next;
+
+		if (node != queue->head && queue->f_destroyNode != NULL) {
+			int destroyCode = queue->f_destroyNode(node->data);
+
+			if (destroyCode != 0) {
+				error = destroyCode;
+			}
+		}
+		allocatorFree(&allocator, node);
+		node = next;
+	}
+
+	/* Records still owned by a thread are left for it to free */
+	record = queue->records;
+	while (record != NULL) {
+		struct HazardRecord *next = record->next;
+		int owned = CQUEUE_RECORD_OWNED;
+		size_t i;
+
+		for (i = 0; i < record->nbRetired; i++) {
+			allocatorFree(&allocator, record->retired[i]);
+		}
+		allocatorFree(&allocator, record->retired);
+		record->retired = NULL;
+		record->nbRetired = record->retiredCapacity = 0;
+
+		if (!ATOMIC_CAS(&(record->state), &owned, CQUEUE_RECORD_ORPHANED)) {
+			allocatorFree(&allocator, record);
+		}
+		record = next;
+	}
+
+	allocatorFree(&allocator, queue), *p_queue = NULL;
+	return error;
+}
+
+
+/* Returns 0 on success, negative number on failure (only on allocation failure) */
+int
+cqueue_insertTail(ConcurrentQueue *queue, void *data) {
+	struct HazardRecord *record;
+	struct QNode *node = new_qnode(queue, data);
+
+	if (node == NULL) {
+		return -1;
+	}
+
+	record = threadRecord(queue);
+	if (record == NULL) {
+		allocatorFree(&(queue->allocator), node);
+		return -1;
+	}
+
+	for (;;) {
+		struct QNode *tail = protect(record, 0, &(queue->tail));
+		struct QNode *next = ATOMIC_LOAD(&(tail->next));
+
+		if (tail != ATOMIC_LOAD(&(queue->tail))) {
+			continue;
+		}
+
+		/* Somebody linked a Node but didn't get to move the tail yet */
+		if (next != NULL) {
+			ATOMIC_CAS(&(queue->tail), &tail, next);
+			continue;
+		}
+
+		if (ATOMIC_CAS(&(tail->next), &next, node)) {
+			/* If this fails, another thread already moved it */
+			ATOMIC_CAS(&(queue->tail), &tail, node);
+			break;
+		}
+	}
+
+	clearHazards(record);
+	return 0;
+}
+
+
+/* Returns NULL if the queue is empty (so NULL data can't be told apart from it)
+ * Caller is responsible of freeing data
+ */
+void *
+cqueue_popHead(ConcurrentQueue *queue) {
+	struct HazardRecord *record = threadRecord(queue);
+	struct QNode *head;
+	void *data;
+
+	if (record == NULL) {
+		return NULL;
+	}
+
+	for (;;) {
+		struct QNode *tail, *next;
+
+		head = protect(record, 0, &(queue->head));
+		tail = ATOMIC_LOAD(&(queue->tail));
+		next = protect(record, 1, &(head->next));
+
+		if (head != ATOMIC_LOAD(&(queue->head))) {
+			continue;
+		}
+
+		if (next == NULL) {
+			clearHazards(record);
+			return NULL;
+		}
+
+		/* Never let the head go past the tail */
+		if (head == tail) {
+			ATOMIC_CAS(&(queue->tail), &tail, next);
+			continue;
+		}
+
+		/* next becomes the new dummy, read its data before anybody can pop it */
+		data = next->data;
+		if (ATOMIC_CAS(&(queue->head), &head, next)) {
+			break;
+		}
+	}
+
+	ATOMIC_STORE(&(record->hazards[0]), (struct QNode *)NULL);
+	retireNode(queue, record, head);
+	clearHazards(record);
+
+	return data;
+}
+
+
+/* Only a snapshot when other threads are using the queue */
+int
+cqueue_isEmpty(ConcurrentQueue *queue) {
+	struct HazardRecord *record = threadRecord(queue);
+	struct QNode *head;
+	int b_empty;
+
+	if (record == NULL) {
+		return -1;
+	}
+
+	head = protect(record, 0, &(queue->head));
+	b_empty = (ATOMIC_LOAD(&(head->next)) == NULL);
+	clearHazards(record);
+
+	return b_empty;
+}
@@ -0,0 +1,56 @@
+/*
+ * Lock-free multi-producer/multi-consumer queue for using lists as work queues
+ * between threads: cqueue_insertTail and cqueue_popHead can be called from any
+ * number of threads at once without any lock.
+ *
+ * Dequeued Nodes are reclaimed with hazard pointers, so a thread stalled in the
+ * middle of an operation never makes the others wait and memory stays bounded.
+ * cqueue_new and cqueue_destroy are not thread-safe.
+ *
+ * Each thread keeps a bit of bookkeeping per queue it used until it exits, so
+ * the queue's allocator has to outlive those threads.
+ */
+
+#ifndef CONCURRENT_QUEUE_H
+#define CONCURRENT_QUEUE_H
+
+#include <stdlib.h> /* size_t */
+
+#include "LinkedList.h" /* nodeDestroyFunc, LlistAllocator */
+
+
+/* Forward declare and typedef internal structs (since callers shouldn't know the internals) */
+typedef struct s_ConcurrentQueue ConcurrentQueue;
+
+
+
+/* === ctor/dtor === */
+
+ConcurrentQueue *
+cqueue_new(nodeDestroyFunc f_destroyNode);
+
+ConcurrentQueue *
+cqueue_newWithAllocator(nodeDestroyFunc f_destroyNode, const LlistAllocator *allocator);
+
+
+int
+cqueue_destroy(ConcurrentQueue **p_queue);
+
+/* === END ctor/dtor === */
+
+
+
+/* === Queue functions === */
+
+int
+cqueue_insertTail(ConcurrentQueue *queue, void *data);
+
+void *
+cqueue_popHead(ConcurrentQueue *queue);
+
+int
+cqueue_isEmpty(ConcurrentQueue *queue);
+
+/* === END Queue functions === */
+
+#endif /* Guard */
@@ -0,0 +1,351 @@
+/*
+ * Intrusive variant of LinkedList, see IntrusiveList.h
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "IntrusiveList.h"
+
+
+struct s_IntrusiveList {
+	LlistHook *head;
+	LlistHook *tail;
+	size_t nbHooks;
+	hookDestroyFunc f_destroyHook;
+	hookCmpFunc f_cmpHook;
+};
+
+
+
+/* === Internal functions === */
+static void
+linkHook(IntrusiveList *ilist, LlistHook *insertPos, LlistHook *hook, LlistDirection dir) {
+	if (insertPos == NULL) {
+		assert(ilist->head == NULL && ilist->tail == NULL);
+		hook->prev = hook->next = NULL;
+		ilist->head = ilist->tail = hook;
+
+	} else if (dir == LLIST_BEFORE) {
+		hook->prev = insertPos->prev;
+		hook->next = insertPos;
+		if (insertPos->prev != NULL) {
+			insertPos->prev->next = hook;
+		} else {
+			ilist->head = hook;
+		}
+		insertPos->prev = hook;
+
+	} else {
+		hook->prev = insertPos;
+		hook->next = insertPos->next;
+		if (insertPos->next != NULL) {
+			insertPos->next->prev = hook;
+		} else {
+			ilist->tail = hook;
+		}
+		insertPos->next = hook;
+	}
+
+	ilist->nbHooks++;
+}
+
+
+static void
+unlinkHook(IntrusiveList *ilist, LlistHook *hook) {
+	assert(ilist->nbHooks > 0);
+
+	if (hook->prev != NULL) {
+		hook->prev->next = hook->next;
+	} else {
+		ilist->head = hook->next;
+	}
+
+	if (hook->next != NULL) {
+		hook->next->prev = hook->prev;
+	} else {
+		ilist->tail = hook->prev;
+	}
+
+	hook->prev = hook->next = NULL;
+	ilist->nbHooks--;
+}
+
+
+/* Same as mergeChains in LinkedList.c, but comparing hooks */
+static LlistHook *
+mergeHookChains(hookCmpFunc f_cmpHook, LlistHook *left, LlistHook *right) {
+	LlistHook *head = NULL;
+	LlistHook **p_link = &head;
+
+	while (left != NULL && right != NULL) {
+		if (f_cmpHook(left, right) <= 0) {
+			*p_link = left;
+			left = left->next;
+		} else {
+			*p_link = right;
+			right = right->next;
+		}
+		p_link = &((*p_link)->next);
+	}
+	*p_link = (left != NULL) ? left : right;
+
+	return head;
+}
+
+
+/* Same as sortChain in LinkedList.c: natural runs are chained through the
+ * prev pointer of their first hook and merged pairwise until one remains */
+static LlistHook *
+sortHookChain(hookCmpFunc f_cmpHook, LlistHook *head) {
+	LlistHook *runs = NULL;
+	LlistHook **p_lastRun = &runs;
+	LlistHook *hook = head;
+
+	while (hook != NULL) {
+		LlistHook *runHead = hook;
+
+		while (hook->next != NULL && f_cmpHook(hook, hook->next) <= 0) {
+			hook = hook->next;
+		}
+
+		*p_lastRun = runHead;
+		p_lastRun = &(runHead->prev);
+
+		runHead = hook->next;
+		hook->next = NULL;
+		hook = runHead;
+	}
+	*p_lastRun = NULL;
+
+	while (runs != NULL && runs->prev != NULL) {
+		LlistHook *merged = NULL;
+		LlistHook **p_merged = &merged;
+		LlistHook *run = runs;
+
+		while (run != NULL) {
+			LlistHook *left = run;
+			LlistHook *right = left->prev;
+
+			if (right == NULL) {
+				run = NULL;
+			} else {
+				run = right->prev;
+				left = mergeHookChains(f_cmpHook, left, right);
+			}
+
+			*p_merged = left;
+			p_merged = &(left->prev);
+		}
+		*p_merged = NULL;
+
+		runs = merged;
+	}
+
+	return runs;
+}
+
+/* === END Internal functions === */
+
+
+
+IntrusiveList *
+ilist_new(hookDestroyFunc f_destroyHook, hookCmpFunc f_cmpHook) {
+	IntrusiveList *ilist = malloc(sizeof (*ilist));
+
+	if (ilist != NULL) {
+		ilist->head = NULL;
+		ilist->tail = NULL;
+		ilist->nbHooks = 0;
+
+		ilist->f_destroyHook = f_destroyHook;
+		ilist->f_cmpHook = f_cmpHook;
+	}
+
+	return ilist;
+}
+
+
+/* Unlinks every hook, handing it to f_destroyHook if there is one */
+int
+ilist_destroy(IntrusiveList **p_ilist) {
+	IntrusiveList *ilist;
+	int error = 0;
+
+	if (p_ilist == NULL || *p_ilist == NULL) {
+		return 0;
+	}
+
+	ilist = *p_ilist;
+	while (ilist->head != NULL) {
+		LlistHook *hook = ilist->head;
+
+		unlinkHook(ilist, hook);
+		if (ilist->f_destroyHook != NULL) {
+			int destroyCode = ilist->f_destroyHook(hook);
+
+			if (destroyCode != 0) {
+				error = destroyCode;
+			}
+		}
+	}
+
+	free(ilist), *p_ilist = NULL;
+	return error;
+}
+
+
+size_t
+ilist_size(IntrusiveList *ilist) {
+	return ilist->nbHooks;
+}
+
+
+LlistHook *
+ilist_getHead(IntrusiveList *ilist) {
+	return ilist->head;
+}
+
+
+LlistHook *
+ilist_getTail(IntrusiveList *ilist) {
+	return ilist->tail;
+}
+
+
+/*
+ * ilist_find
+ *
+ * start: the hook to start the search at (included)
+ * probe: hook to match such that ilist->f_cmpHook(probe, hook) == 0, usually
+ *        embedded in a struct on the stack which only has its key set
+ *
+ * Returns the matching hook or NULL
+ */
+LlistHook *
+ilist_find(IntrusiveList *ilist, LlistHook *start, LlistHook *probe, LlistDirection searchDir) {
+	LlistHook *hook;
+
+	if (searchDir != LLIST_BEFORE && searchDir != LLIST_AFTER) {
+		return NULL;
+	}
+
+	for (hook = start; hook != NULL; hook = (searchDir == LLIST_AFTER) ? hook->next : hook->prev) {
+		if (0 == ilist->f_cmpHook(probe, hook)) {
+			return hook;
+		}
+	}
+
+	return NULL;
+}
+
+
+size_t
+ilist_countMatch(IntrusiveList *ilist, LlistHook *probe) {
+	LlistHook *hook;
+	size_t count = 0;
+
+	for (hook = ilist->head; hook != NULL; hook = hook->next) {
+		if (0 == ilist->f_cmpHook(probe, hook)) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+
+/* Stable, allocation-free merge sort (see llist_mergeSort) */
+int
+ilist_mergeSort(IntrusiveList *ilist) {
+	LlistHook *hook, *prev = NULL;
+
+	if (ilist->head == NULL) {
+		return 0;
+	}
+
+	ilist->head = sortHookChain(ilist->f_cmpHook, ilist->head);
+	for (hook = ilist->head; hook != NULL; prev = hook, hook = hook->next) {
+		hook->prev = prev;
+	}
+	ilist->tail = prev;
+
+	return 0;
+}
+
+
+/* Returns 0 on success, negative number on failure */
+int
+ilist_insertHead(IntrusiveList *ilist, LlistHook *hook) {
+	if (hook == NULL) {
+		return -1;
+	}
+
+	linkHook(ilist, ilist->head, hook, LLIST_BEFORE);
+	return 0;
+}
+
+
+/* Returns 0 on success, negative number on failure */
+int
+ilist_insertTail(IntrusiveList *ilist, LlistHook *hook) {
+	if (hook == NULL) {
+		return -1;
+	}
+
+	linkHook(ilist, ilist->tail, hook, LLIST_AFTER);
+	return 0;
+}
+
+
+/* Inserts hook before or after insertPos, which must be in ilist
+ * Returns 0 on success, negative number on failure
+ */
+int
+ilist_insert(IntrusiveList *ilist, LlistHook *insertPos, LlistHook *hook, LlistDirection dir) {
+	if (insertPos == NULL || hook == NULL) {
+		return -2;
+	}
+	if (dir != LLIST_BEFORE && dir != LLIST_AFTER) {
+		return -1;
+	}
+
+	linkHook(ilist, insertPos, hook, dir);
+	return 0;
+}
+
+
+/* Unlinks hook (which must be in ilist) without destroying it */
+int
+ilist_pop(IntrusiveList *ilist, LlistHook *hook) {
+	if (hook == NULL) {
+		return -1;
+	}
+
+	unlinkHook(ilist, hook);
+	return 0;
+}
+
+
+/* Returns NULL if the list is empty */
+LlistHook *
+ilist_popHead(IntrusiveList *ilist) {
+	LlistHook *hook = ilist->head;
+
+	if (hook != NULL) {
+		unlinkHook(ilist, hook);
+	}
+	return hook;
+}
+
+
+/* Returns NULL if the list is empty */
+LlistHook *
+ilist_popTail(IntrusiveList *ilist) {
+	LlistHook *hook = ilist->tail;
+
+	if (hook != NULL) {
+		unlinkHook(ilist, hook);
+	}
+	return hook;
+}
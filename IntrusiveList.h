@@ -0,0 +1,109 @@
+/*
+ * Intrusive variant of LinkedList: callers embed a LlistHook in their own
+ * structs and the list links those hooks directly, so inserting or popping
+ * never allocates or frees anything.
+ *
+ * struct Item {
+ *     int key;
+ *     LlistHook hook;
+ * };
+ *
+ * struct Item *item = LLIST_CONTAINER_OF(ilist_popHead(ilist), struct Item, hook);
+ *
+ * A hook can only be in one list at a time.
+ */
+
+#ifndef INTRUSIVE_LIST_H
+#define INTRUSIVE_LIST_H
+
+#include <stdlib.h> /* size_t */
+#include <stddef.h> /* offsetof */
+
+#include "LinkedList.h" /* LlistDirection */
+
+
+typedef struct s_LlistHook {
+	struct s_LlistHook *prev;
+	struct s_LlistHook *next;
+} LlistHook;
+
+
+/* Gets back the struct of type type whose LlistHook member is hook */
+#define LLIST_CONTAINER_OF(hook, type, member) \
+	((type *)((char *)(hook) - offsetof(type, member)))
+
+
+typedef int (*hookDestroyFunc)(LlistHook *);
+typedef int (*hookCmpFunc)(LlistHook *, LlistHook *);
+
+
+/* Forward declare and typedef internal structs (since callers shouldn't know the internals) */
+typedef struct s_IntrusiveList IntrusiveList;
+
+
+
+/* === ctor/dtor === */
+
+IntrusiveList *
+ilist_new(hookDestroyFunc f_destroyHook, hookCmpFunc f_cmpHook);
+
+
+int
+ilist_destroy(IntrusiveList **p_ilist);
+
+/* === END ctor/dtor === */
+
+
+
+/* === Query functions === */
+
+size_t
+ilist_size(IntrusiveList *ilist);
+
+LlistHook *
+ilist_getHead(IntrusiveList *ilist);
+
+LlistHook *
+ilist_getTail(IntrusiveList *ilist);
+
+LlistHook *
+ilist_find(IntrusiveList *ilist, LlistHook *start, LlistHook *probe, LlistDirection searchDir);
+
+size_t
+ilist_countMatch(IntrusiveList *ilist, LlistHook *probe);
+
+/* === END Query functions === */
+
+
+/* === Mutator functions === */
+int
+ilist_mergeSort(IntrusiveList *ilist);
+/* === END Mutator functions === */
+
+
+/* === Insert functions === */
+int
+ilist_insertHead(IntrusiveList *ilist, LlistHook *hook);
+
+int
+ilist_insertTail(IntrusiveList *ilist, LlistHook *hook);
+
+int
+ilist_insert(IntrusiveList *ilist, LlistHook *insertPos, LlistHook *hook, LlistDirection dir);
+
+/* === END Insert functions === */
+
+
+/* === Delete functions === */
+int
+ilist_pop(IntrusiveList *ilist, LlistHook *hook);
+
+LlistHook *
+ilist_popHead(IntrusiveList *ilist);
+
+LlistHook *
+ilist_popTail(IntrusiveList *ilist);
+
+/* === END Delete functions === */
+
+#endif /* Guard */
@@ -4,15 +4,79 @@
  */
 
 #include <stdlib.h>
+#include <stddef.h> /* offsetof */
+#include <string.h> /* memcpy */
 #include <assert.h>
+#include <pthread.h>
 
 #include "LinkedList.h"
+#include "LlistAtomic.h"
+#include "LlistPool.h"
+#include "LlistTrace.h"
 
 
 #ifndef DEBUG
 	#define DEBUG 0
 #endif
 
+/* Nodes carved per chunk when llist_newPooled() is given 0 */
+#define LLIST_DEFAULT_CHUNK_NODES 256
+
+/* nbNodes after an O(1) splice or split, recounted on demand by listSize() */
+#define LLIST_SIZE_UNKNOWN ((size_t)-1)
+
+/* Smallest number of buckets of a NodeIndex (always a power of 2) */
+#define LLIST_INDEX_MIN_BUCKETS 16
+
+/* Express lanes of ordered lists, 1 in 4 Nodes of a lane makes it to the next */
+#define LLIST_SKIP_MAX_LEVEL 16
+
+/* Smallest number of Nodes per thread worth a thread in llist_parallelSort */
+#define LLIST_PARALLEL_MIN_NODES 4096
+
+/* Slices of llist_sortByKey's introsort finished by an insertion sort */
+#define LLIST_INSERTION_SORT_MAX 16
+
+/* Bits of the key sorted per pass of llist_sortByKey's radix sort */
+#define LLIST_RADIX_BITS 8
+#define LLIST_RADIX_BUCKETS (1 << LLIST_RADIX_BITS)
+
+/* Bulk traversals cut lists in that many chunks per thread, so there is work to steal */
+#define LLIST_CHUNKS_PER_THREAD 8
+
+/* Retired Nodes piling up before trying to reclaim some (see llist_enableEpochs) */
+#define LLIST_EPOCH_BATCH 64
+
+#define LLIST_CACHE_LINE 64
+
+
+/* Operation counters (see llist_getStats), compiled out unless LLIST_STATS is defined */
+#ifdef LLIST_STATS
+	#define STATS_OF(llist) (&((llist)->stats))
+	#define STAT_ADD(stats, counter, n) ((stats)->counter += (n))
+	#define STAT_PEAK(llist) \
+		((llist)->nbNodes != LLIST_SIZE_UNKNOWN && (llist)->nbNodes > (llist)->stats.peakSize \
+				? (void)((llist)->stats.peakSize = (llist)->nbNodes) : (void)0)
+#else
+	#define STATS_OF(llist) NULL
+	#define STAT_ADD(stats, counter, n) ((void)0)
+	#define STAT_PEAK(llist) ((void)0)
+#endif
+
+/* Times call as op on llist (see llist_setTraceHooks), compiled out unless LLIST_TRACE is defined */
+#ifdef LLIST_TRACE
+	#define TRACE_CALL(op, llist, call) do { \
+		double traceStart = llistTrace_begin((op), (llist)); \
+		call; \
+		llistTrace_end((op), (llist), traceStart); \
+	} while (0)
+#else
+	#define TRACE_CALL(op, llist, call) call
+#endif
+
+#define CMP_NODES(llist, data1, data2) \
+	(STAT_ADD(STATS_OF(llist), nbCmps, 1), (llist)->f_cmpNode((data1), (data2)))
+
 
 struct Node {
 	struct Node *prev;
@@ -21,16 +85,182 @@ struct Node {
 };
 
 
+/* Node of a list with a key function (see llist_setKeyFunc), so that other
+ * lists don't pay for the key */
+struct KeyedNode {
+	struct Node node;
+	/* f_keyNode(node.data) */
+	unsigned long key;
+};
+
+#define NODE_KEY(node) (((struct KeyedNode *)(node))->key)
+
+
+/* Header of a block of Nodes handed out by a NodePool (the Nodes follow it,
+ * see chunkNode) */
+struct NodeChunk {
+	struct NodeChunk *next;
+	struct Node nodes[1];
+};
+
+
+/* Nodes are carved in order from the most recent chunk (so they are contiguous)
+ * and recycled through freeNodes, which is linked through Node->next
+ *
+ * Lists created by llist_splitAt share their pool with the original list
+ * (hence refCount) so that Nodes can keep moving between them
+ */
+struct NodePool {
+	struct NodeChunk *chunks;
+	struct Node *freeNodes;
+	size_t chunkNodes;
+	size_t nbCarved;
+	size_t refCount;
+	/* sizeof (struct Node) or sizeof (struct KeyedNode), see nodeSizeOf */
+	size_t nodeSize;
+};
+
+
+struct IndexEntry {
+	struct IndexEntry *next;
+	struct Node *node;
+	size_t hash;
+};
+
+
+/* Maps the hash of Node data to the Nodes with that hash (see llist_enableIndex)
+ * Removed entries are kept in freeEntries for reuse
+ */
+struct NodeIndex {
+	nodeHashFunc f_hashNode;
+	struct IndexEntry **buckets;
+	size_t nbBuckets;
+	size_t nbEntries;
+	struct IndexEntry *freeEntries;
+};
+
+
+/* Express lane entry of an ordered list's Node. The Node chain itself is the
+ * bottom lane, next[0] skips to the next Node which has a tower and so on
+ */
+struct SkipTower {
+	struct Node *node;
+	size_t height;
+	struct SkipTower *next[1];
+};
+
+
+struct SkipList {
+	struct SkipTower *heads[LLIST_SKIP_MAX_LEVEL];
+	size_t height;
+	unsigned long seed;
+};
+
+
+/* epoch is 0 outside of read-side sections and globalEpoch * 2 + 1 inside
+ * Only its reader writes it, the padding keeps readers off each other's cache line
+ */
+struct s_LlistReader {
+	size_t epoch;
+	struct s_LlistReader *next;
+	int b_inUse;
+	char pad[LLIST_CACHE_LINE];
+};
+
+
+struct RetiredNode {
+	struct Node *node;
+	nodeDestroyFunc f_destroyNode;
+	size_t epoch;
+};
+
+
+/* Nodes removed while readers may be on them are retired with the epoch of
+ * their removal and freed once the epoch moved 2 steps further: by then
+ * every reader which could have seen them has left its read-side section.
+ * retired is sorted by epoch since the epoch never goes back
+ */
+struct EpochState {
+	size_t globalEpoch;
+	struct s_LlistReader *readers;
+	struct RetiredNode *retired;
+	size_t nbRetired;
+	size_t retiredCapacity;
+};
+
+
 struct s_LinkedList {
 	struct Node *head;
 	struct Node *tail;
 	nodeDestroyFunc f_destroyNode;
 	nodeCmpFunc f_cmpNode;
+	LlistAllocator allocator;
+	struct NodePool *pool;
+	size_t nbNodes;
+
+	/* Last Node reached by llistCursor_seek (NULL when unknown) and its index */
+	struct Node *finger;
+	size_t fingerIndex;
+
+	struct NodeIndex *index;
+
+	/* Only for lists created by llist_newOrdered */
+	struct SkipList *skipList;
+
+	/* Only once llist_enableEpochs was called */
+	struct EpochState *epochs;
+
+	/* Optional, see llist_setKeyFunc */
+	nodeKeyFunc f_keyNode;
+	int b_exactKey;
+
+#ifdef LLIST_STATS
+	LlistStats stats;
+#endif
+};
+
+
+/* What llistCursor_new actually allocates, the user only sees &node */
+struct CursorBlock {
+	LlistAllocator allocator;
+	struct Node *node;
 };
 
 
 
 /* === Internal functions === */
+static void *
+defaultAlloc(void *context, size_t size) {
+	(void)context;
+	return malloc(size);
+}
+
+
+static void
+defaultFree(void *context, void *ptr) {
+	(void)context;
+	free(ptr);
+}
+
+
+static const LlistAllocator defaultAllocator = { defaultAlloc, defaultFree, NULL };
+
+
+static void *
+allocatorAlloc(const LlistAllocator *allocator, size_t size) {
+	return allocator->f_alloc(allocator->context, size);
+}
+
+
+/* f_free is NULL for arenas which release everything at once */
+static void
+allocatorFree(const LlistAllocator *allocator, void *ptr) {
+	if (allocator->f_free != NULL) {
+		allocator->f_free(allocator->context, ptr);
+	}
+}
+
+
 static void
 assertList(LinkedList *llist) {
 	if (DEBUG) {
@@ -51,571 +281,3794 @@ isUserPointerValid(struct Node **cursor) {
 }
 
 
+/* Size of the Nodes of lists with (or without) a key function */
+static size_t
+nodeSizeOf(nodeKeyFunc f_keyNode) {
+	return (f_keyNode != NULL) ? sizeof (struct KeyedNode) : sizeof (struct Node);
+}
+
+
+/* Size of a NodeChunk holding nbNodes Nodes of nodeSize bytes */
+static size_t
+chunkSize(size_t nodeSize, size_t nbNodes) {
+	return offsetof (struct NodeChunk, nodes) + nbNodes * nodeSize;
+}
+
+
 static struct Node *
-new_node(void *data) {
-	struct Node *node = malloc(sizeof (*node));
+chunkNode(struct NodeChunk *chunk, size_t nodeSize, size_t i) {
+	return (struct Node *)((char *)chunk->nodes + i * nodeSize);
+}
 
-	if (node != NULL) {
-		node->prev = node->next = NULL;
-		node->data = data;
+
+/* Empty pool with a single reference, NULL on allocation failure */
+static struct NodePool *
+new_pool(const LlistAllocator *allocator, size_t chunkNodes, size_t nodeSize) {
+	struct NodePool *pool = allocatorAlloc(allocator, sizeof (*pool));
+
+	if (pool != NULL) {
+		pool->chunks = NULL;
+		pool->freeNodes = NULL;
+		pool->chunkNodes = chunkNodes;
+		pool->nbCarved = 0;
+		pool->refCount = 1;
+		pool->nodeSize = nodeSize;
 	}
 
-	return node;
+	return pool;
 }
 
 
-static int
-destroyNode(nodeDestroyFunc f_destroyNode, struct Node **p_node) {
-	int destroyCode;
+static struct Node *
+poolAllocNode(const LlistAllocator *allocator, struct NodePool *pool) {
 	struct Node *node;
 
-	/* Not actually a user pointer, just a double pointer to Node this time */
-	if (!isUserPointerValid(p_node)) {
-		return -256;
+	if (pool->freeNodes != NULL) {
+		node = pool->freeNodes;
+		pool->freeNodes = node->next;
+		return node;
 	}
 
-	node = *p_node;
+	if (pool->chunks == NULL || pool->nbCarved == pool->chunkNodes) {
+		struct NodeChunk *chunk = allocatorAlloc(allocator, chunkSize(pool->nodeSize, pool->chunkNodes));
 
-	if (f_destroyNode != NULL) {
-		destroyCode = f_destroyNode(node->data);
+		if (chunk == NULL) {
+			return NULL;
+		}
+		chunk->next = pool->chunks;
+		pool->chunks = chunk;
+		pool->nbCarved = 0;
 	}
-	free(node), *p_node = node = NULL;
 
-	return destroyCode;
+	return chunkNode(pool->chunks, pool->nodeSize, pool->nbCarved++);
 }
 
 
-static int
-isTail(LinkedList *llist, struct Node *node) {
-	assertList(llist);
-	/* node can be NULL only if the list is empty */
-	assert(node != NULL || llist->tail == NULL);
+static void
+poolFreeNode(struct NodePool *pool, struct Node *node) {
+	node->next = pool->freeNodes;
+	pool->freeNodes = node;
+}
 
-	if (llist->tail == node || node->next == NULL) {
-		assert(llist->tail == node && (node == NULL || node->next == NULL));
-		return 1;
 
-	} else {
-		assert(llist->tail != node && node->next != NULL);
-		return 0;
-	}
-}
+static void
+poolRelease(const LlistAllocator *allocator, struct NodePool **p_pool) {
+	struct NodeChunk *chunk = (*p_pool)->chunks;
 
+	if (--(*p_pool)->refCount > 0) {
+		*p_pool = NULL;
+		return;
+	}
 
-static int
-isHead(LinkedList *llist, struct Node *node) {
-	assertList(llist);
-	/* node can be NULL only if the list is empty */
-	assert(node != NULL || llist->head == NULL);
+	while (chunk != NULL) {
+		struct NodeChunk *next = chunk->next;
 
-	if (llist->head == node || node->prev == NULL) {
-		assert(llist->head == node && (node == NULL || node->prev == NULL));
-		return 1;
-	} else {
-		assert(llist->head != node && node->prev != NULL);
-		return 0;
+		allocatorFree(allocator, chunk);
+		chunk = next;
 	}
+	allocatorFree(allocator, *p_pool), *p_pool = NULL;
 }
 
 
-static int
-insertNode(LinkedList *llist, struct Node **p_insertPos, struct Node *newNode, LlistDirection dir) {
-	int isEdge = 0;
+static struct IndexEntry **
+indexBucket(struct NodeIndex *index, size_t hash) {
+	return &(index->buckets[hash & (index->nbBuckets - 1)]);
+}
 
-	assertList(llist);
-	/* p_insertPos CAN'T be NULL (although insertPos can be NULL if the list is empty) */
-	assert(p_insertPos != NULL && newNode != NULL);
-	assert(newNode->next == NULL && newNode->prev == NULL);
 
-	switch (dir) {
-	case LLIST_BEFORE:
-		newNode->next = *p_insertPos;
+/* Keeps the old buckets if the new ones can't be allocated */
+static void
+indexResize(const LlistAllocator *allocator, struct NodeIndex *index, size_t nbBuckets) {
+	struct IndexEntry **oldBuckets = index->buckets;
+	size_t oldNbBuckets = index->nbBuckets;
+	size_t i;
+
+	index->buckets = allocatorAlloc(allocator, nbBuckets * sizeof (*index->buckets));
+	if (index->buckets == NULL) {
+		index->buckets = oldBuckets;
+		return;
+	}
+	index->nbBuckets = nbBuckets;
 
-		/* Inserting before the head node (*p_insertPos is NULL if list is empty) */
-		if (isHead(llist, *p_insertPos)) {
-			isEdge = 1;
-			newNode->prev = NULL;
+	for (i = 0; i < nbBuckets; i++) {
+		index->buckets[i] = NULL;
+	}
 
-		/* Inserting before some other node */
-		} else {
-			/* We should have more than one element */
-			assert(llist->head != llist->tail);
+	for (i = 0; i < oldNbBuckets; i++) {
+		struct IndexEntry *entry = oldBuckets[i];
 
-			newNode->prev = (*p_insertPos)->prev;
+		while (entry != NULL) {
+			struct IndexEntry *next = entry->next;
+			struct IndexEntry **p_bucket = indexBucket(index, entry->hash);
 
-			/* The Node before the insertPos was still pointing to insertPos */
-			(*p_insertPos)->prev->next = newNode;
+			entry->next = *p_bucket;
+			*p_bucket = entry;
+			entry = next;
 		}
+	}
 
-		if (*p_insertPos != NULL) {
-			(*p_insertPos)->prev = newNode;
-		}
+	if (oldBuckets != NULL) {
+		allocatorFree(allocator, oldBuckets);
+	}
+}
 
-		/* We need to touch the head only after everything is done
-		 * otherwise we will set the head (setting *p_insertPos at the same time in some cases) */
-		if (isEdge) {
-			llist->head = newNode;
 
-			if (llist->tail == NULL) {
-				llist->tail = newNode;
-			}
+static int
+indexAdd(LinkedList *llist, struct Node *node) {
+	struct NodeIndex *index = llist->index;
+	struct IndexEntry *entry;
+	struct IndexEntry **p_bucket;
+
+	if (index->freeEntries != NULL) {
+		entry = index->freeEntries;
+		index->freeEntries = entry->next;
+	} else {
+		entry = allocatorAlloc(&(llist->allocator), sizeof (*entry));
+		if (entry == NULL) {
+			return -1;
 		}
-		break;
-	case LLIST_AFTER:
-		newNode->prev = *p_insertPos;
+	}
 
-		/* Inserting after the tail node (*p_insertPos is NULL if list is empty) */
-		if (isTail(llist, *p_insertPos)) {
-			isEdge = 1;
-			newNode->next = NULL;
+	if (index->nbEntries >= index->nbBuckets) {
+		indexResize(&(llist->allocator), index, index->nbBuckets * 2);
+	}
 
-		/* Inserting after some other node */
-		} else {
-			/* We should have more than one element */
-			assert(llist->head != llist->tail);
+	entry->node = node;
+	entry->hash = index->f_hashNode(node->data);
 
-			newNode->next = (*p_insertPos)->next;
+	p_bucket = indexBucket(index, entry->hash);
+	entry->next = *p_bucket;
+	*p_bucket = entry;
+	index->nbEntries++;
 
-			/* The Node after the insertPos was still pointing to insertPos */
-			(*p_insertPos)->next->prev = newNode;
-		}
+	return 0;
+}
 
-		if (*p_insertPos != NULL) {
-			(*p_insertPos)->next = newNode;
-		}
 
-		/* See comment about head above */
-		if (isEdge) {
-			llist->tail = newNode;
+/* Unlinks the entry of node from its bucket (hash being the hash of node's data) */
+static struct IndexEntry *
+indexDetach(struct NodeIndex *index, struct Node *node, size_t hash) {
+	struct IndexEntry **p_entry;
 
-			if (llist->head == NULL) {
-				llist->head = newNode;
-			}
+	for (p_entry = indexBucket(index, hash); *p_entry != NULL; p_entry = &((*p_entry)->next)) {
+		struct IndexEntry *entry = *p_entry;
+
+		if (entry->node == node) {
+			*p_entry = entry->next;
+			return entry;
 		}
-		break;
-	default:
-		return -1;
-		break;
 	}
 
-	return 0;
+	assert(!"Node missing from the index");
+	return NULL;
 }
 
 
-static int
-insertHead(LinkedList *llist, struct Node *node) {
-	return insertNode(llist, &(llist->head), node, LLIST_BEFORE);
+static void
+indexRemove(LinkedList *llist, struct Node *node) {
+	struct NodeIndex *index = llist->index;
+	struct IndexEntry *entry = indexDetach(index, node, index->f_hashNode(node->data));
+
+	if (entry != NULL) {
+		entry->next = index->freeEntries;
+		index->freeEntries = entry;
+		index->nbEntries--;
+	}
+}
+
+
+static void
+indexDestroy(const LlistAllocator *allocator, struct NodeIndex **p_index) {
+	struct NodeIndex *index = *p_index;
+	size_t i;
+
+	for (i = 0; i < index->nbBuckets; i++) {
+		while (index->buckets[i] != NULL) {
+			struct IndexEntry *entry = index->buckets[i];
+
+			index->buckets[i] = entry->next;
+			allocatorFree(allocator, entry);
+		}
+	}
+	while (index->freeEntries != NULL) {
+		struct IndexEntry *entry = index->freeEntries;
+
+		index->freeEntries = entry->next;
+		allocatorFree(allocator, entry);
+	}
+
+	allocatorFree(allocator, index->buckets);
+	allocatorFree(allocator, index), *p_index = NULL;
 }
 
 
+/* Is nodeData before key (or not after it if b_after) */
 static int
-insertTail(LinkedList *llist, struct Node *node) {
-	return insertNode(llist, &(llist->tail), node, LLIST_AFTER);
+isBefore(LinkedList *llist, void *nodeData, void *key, int b_after) {
+	int cmp = CMP_NODES(llist, nodeData, key);
+
+	return b_after ? cmp <= 0 : cmp < 0;
 }
 
 
+/* Finds the first Node which isn't before key (see isBefore) going down the
+ * express lanes. If update isn't NULL, update[level] is set to the last tower
+ * of each lane before key (NULL if there is none)
+ */
 static struct Node *
-popNode(LinkedList *llist, struct Node *node) {
-	struct Node *prev, *next;
-
-	assertList(llist);
-	assert(node != NULL);
+skipSeek(LinkedList *llist, void *key, int b_after, struct SkipTower **update) {
+	struct SkipList *skipList = llist->skipList;
+	struct SkipTower *pred = NULL;
+	struct Node *node;
+	size_t level;
 
-	prev = node->prev;
-	next = node->next;
+	for (level = skipList->height; level-- > 0; ) {
+		struct SkipTower *tower = (pred != NULL) ? pred->next[level] : skipList->heads[level];
 
-	if (isHead(llist, node)) {
-		llist->head = next;
-		if (next != NULL) {
-			next->prev = NULL;
+		while (tower != NULL && isBefore(llist, tower->node->data, key, b_after)) {
+			pred = tower;
+			tower = tower->next[level];
 		}
-
-	} else if (isTail(llist, node)) {
-		llist->tail = prev;
-		if (prev != NULL) {
-			prev->next = NULL;
+		if (update != NULL) {
+			update[level] = pred;
 		}
+	}
 
-	} else {
-		next->prev = prev;
-		prev->next = next;
+	node = (pred != NULL) ? pred->node->next : llist->head;
+	while (node != NULL && isBefore(llist, node->data, key, b_after)) {
+		node = node->next;
 	}
 
 	return node;
 }
 
 
-static struct Node *
-popHeadNode(LinkedList *llist) {
-	return popNode(llist, llist->head);
-}
+/* xorshift, kept to 32 bits so it behaves the same whatever the size of long */
+static unsigned long
+skipRandom(struct SkipList *skipList) {
+	unsigned long x = skipList->seed;
 
+	x ^= (x << 13) & 0xFFFFFFFFUL;
+	x ^= x >> 17;
+	x ^= (x << 5) & 0xFFFFFFFFUL;
+	skipList->seed = x;
 
-static struct Node *
-popTailNode(LinkedList *llist) {
-	return popNode(llist, llist->tail);
+	return x;
 }
 
 
-/* === END Internal functions === */
+/* Gives node (just linked in the chain) a tower of random height, update being
+ * what skipSeek gave for its position. Without memory for the tower, node
+ * simply stays in the bottom lane only
+ */
+static void
+skipAddTower(LinkedList *llist, struct Node *node, struct SkipTower **update) {
+	struct SkipList *skipList = llist->skipList;
+	struct SkipTower *tower;
+	unsigned long bits = skipRandom(skipList);
+	size_t height = 0;
+	size_t level;
+
+	while (height < LLIST_SKIP_MAX_LEVEL && (bits & 3) == 0) {
+		height++;
+		bits >>= 2;
+	}
+	if (height == 0) {
+		return;
+	}
 
+	tower = allocatorAlloc(&(llist->allocator),
+			offsetof(struct SkipTower, next) + height * sizeof (tower->next[0]));
+	if (tower == NULL) {
+		return;
+	}
+	tower->node = node;
+	tower->height = height;
 
+	for (level = 0; level < height; level++) {
+		struct SkipTower **p_link = (level < skipList->height && update[level] != NULL)
+				? &(update[level]->next[level])
+				: &(skipList->heads[level]);
 
-LinkedList *
-llist_new(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode) {
-	LinkedList *llist = malloc(sizeof (*llist));
+		tower->next[level] = *p_link;
+		*p_link = tower;
+	}
 
-	assert(llist != NULL);
+	if (height > skipList->height) {
+		skipList->height = height;
+	}
+}
 
-	if (llist != NULL) {
-		llist->head = NULL;
-		llist->tail = NULL;
+
+/* Removes the tower of node (if it has one) from the express lanes */
+static void
+skipRemoveTower(LinkedList *llist, struct Node *node) {
+	struct SkipList *skipList = llist->skipList;
+	struct SkipTower *update[LLIST_SKIP_MAX_LEVEL];
+	struct SkipTower *found = NULL;
+	size_t level;
+
+	if (skipList->height == 0) {
+		return;
+	}
+
+	skipSeek(llist, node->data, 0, update);
+
+	/* Towers of Nodes equal to node can come before its own in every lane */
+	for (level = skipList->height; level-- > 0; ) {
+		struct SkipTower **p_tower = (update[level] != NULL)
+				? &(update[level]->next[level])
+				: &(skipList->heads[level]);
+
+		while (*p_tower != NULL && (*p_tower)->node != node
+				&& 0 == CMP_NODES(llist, (*p_tower)->node->data, node->data)) {
+			p_tower = &((*p_tower)->next[level]);
+		}
+
+		if (*p_tower != NULL && (*p_tower)->node == node) {
+			found = *p_tower;
+			*p_tower = found->next[level];
+		}
+	}
+
+	if (found != NULL) {
+		allocatorFree(&(llist->allocator), found);
+		while (skipList->height > 0 && skipList->heads[skipList->height - 1] == NULL) {
+			skipList->height--;
+		}
+	}
+}
+
+
+static void
+skipDestroy(const LlistAllocator *allocator, struct SkipList **p_skipList) {
+	struct SkipTower *tower = (*p_skipList)->heads[0];
+
+	/* Every tower is in the lowest express lane */
+	while (tower != NULL) {
+		struct SkipTower *next = tower->next[0];
+
+		allocatorFree(allocator, tower);
+		tower = next;
+	}
+
+	allocatorFree(allocator, *p_skipList), *p_skipList = NULL;
+}
+
+
+static struct Node *
+new_node(LinkedList *llist, void *data) {
+	struct Node *node;
+
+	if (llist->pool != NULL) {
+		node = poolAllocNode(&(llist->allocator), llist->pool);
+	} else {
+		node = allocatorAlloc(&(llist->allocator), nodeSizeOf(llist->f_keyNode));
+	}
+
+	if (node != NULL) {
+		STAT_ADD(STATS_OF(llist), nbAllocs, 1);
+		node->prev = node->next = NULL;
+		node->data = data;
+		if (llist->f_keyNode != NULL) {
+			NODE_KEY(node) = llist->f_keyNode(data);
+		}
+	}
+
+	return node;
+}
+
+
+static int
+destroyNode(LinkedList *llist, nodeDestroyFunc f_destroyNode, struct Node **p_node) {
+	int destroyCode = 0;
+	struct Node *node;
+
+	/* Not actually a user pointer, just a double pointer to Node this time */
+	if (!isUserPointerValid(p_node)) {
+		return -256;
+	}
+
+	node = *p_node;
+
+	if (f_destroyNode != NULL) {
+		destroyCode = f_destroyNode(node->data);
+	}
+	if (llist->pool != NULL) {
+		poolFreeNode(llist->pool, node);
+	} else {
+		allocatorFree(&(llist->allocator), node);
+	}
+	STAT_ADD(STATS_OF(llist), nbFrees, 1);
+	*p_node = node = NULL;
+
+	return destroyCode;
+}
+
+
+/* Does node hold data equal to data (whose key is key, if the list has keys)
+ * Different keys rule a match out without calling f_cmpNode, and so do equal
+ * exact keys the other way around
+ */
+static int
+nodeMatches(LinkedList *llist, struct Node *node, void *data, unsigned long key) {
+	if (llist->f_keyNode != NULL) {
+		if (NODE_KEY(node) != key) {
+			return 0;
+		}
+		if (llist->b_exactKey) {
+			return 1;
+		}
+	}
+	return 0 == CMP_NODES(llist, data, node->data);
+}
+
+
+/* Key of data to give nodeMatches */
+static unsigned long
+probeKey(LinkedList *llist, void *data) {
+	return (llist->f_keyNode != NULL) ? llist->f_keyNode(data) : 0;
+}
+
+
+/* Key node already holds, to give nodeMatches */
+static unsigned long
+nodeKey(LinkedList *llist, struct Node *node) {
+	return (llist->f_keyNode != NULL) ? NODE_KEY(node) : 0;
+}
+
+
+static int
+isTail(LinkedList *llist, struct Node *node) {
+	assertList(llist);
+	/* node can be NULL only if the list is empty */
+	assert(node != NULL || llist->tail == NULL);
+
+	if (llist->tail == node || node->next == NULL) {
+		assert(llist->tail == node && (node == NULL || node->next == NULL));
+		return 1;
+
+	} else {
+		assert(llist->tail != node && node->next != NULL);
+		return 0;
+	}
+}
+
+
+static int
+isHead(LinkedList *llist, struct Node *node) {
+	assertList(llist);
+	/* node can be NULL only if the list is empty */
+	assert(node != NULL || llist->head == NULL);
+
+	if (llist->head == node || node->prev == NULL) {
+		assert(llist->head == node && (node == NULL || node->prev == NULL));
+		return 1;
+	} else {
+		assert(llist->head != node && node->prev != NULL);
+		return 0;
+	}
+}
+
+
+/* Keeps the finger's index right when a Node is inserted next to insertPos
+ * Inserting in the middle of the list anywhere else loses the finger
+ */
+static void
+fingerOnInsert(LinkedList *llist, struct Node *insertPos, int isEdge, LlistDirection dir) {
+	if (llist->finger == NULL) {
+		return;
+	}
+
+	if (dir == LLIST_BEFORE) {
+		if (isEdge || insertPos == llist->finger) {
+			llist->fingerIndex++;
+		} else {
+			llist->finger = NULL;
+		}
+	} else if (!isEdge && insertPos != llist->finger) {
+		llist->finger = NULL;
+	}
+}
+
+
+/* Same as fingerOnInsert for the removal of node */
+static void
+fingerOnPop(LinkedList *llist, struct Node *node, int b_head, int b_tail) {
+	if (llist->finger == NULL) {
+		return;
+	}
+
+	if (node == llist->finger) {
+		if (node->next != NULL) {
+			llist->finger = node->next;
+		} else {
+			llist->finger = node->prev;
+			llist->fingerIndex--;
+		}
+	} else if (b_head) {
+		llist->fingerIndex--;
+	} else if (!b_tail) {
+		llist->finger = NULL;
+	}
+}
+
+
+static int
+insertNode(LinkedList *llist, struct Node **p_insertPos, struct Node *newNode, LlistDirection dir) {
+	int isEdge = 0;
+	struct Node *insertPos;
+
+	assertList(llist);
+	/* p_insertPos CAN'T be NULL (although insertPos can be NULL if the list is empty) */
+	assert(p_insertPos != NULL && newNode != NULL);
+	assert(newNode->next == NULL && newNode->prev == NULL);
+
+	if (dir != LLIST_BEFORE && dir != LLIST_AFTER) {
+		return -1;
+	}
+	if (llist->index != NULL && indexAdd(llist, newNode) != 0) {
+		return -4;
+	}
+
+	insertPos = *p_insertPos;
+
+	switch (dir) {
+	case LLIST_BEFORE:
+		newNode->next = *p_insertPos;
+
+		/* Inserting before the head node (*p_insertPos is NULL if list is empty) */
+		if (isHead(llist, *p_insertPos)) {
+			isEdge = 1;
+			newNode->prev = NULL;
+
+		/* Inserting before some other node */
+		} else {
+			/* We should have more than one element */
+			assert(llist->head != llist->tail);
+
+			newNode->prev = (*p_insertPos)->prev;
+
+			/* The Node before the insertPos was still pointing to insertPos */
+			ATOMIC_STORE_RELEASE(&((*p_insertPos)->prev->next), newNode);
+		}
+
+		if (*p_insertPos != NULL) {
+			ATOMIC_STORE_RELEASE(&((*p_insertPos)->prev), newNode);
+		}
+
+		/* We need to touch the head only after everything is done
+		 * otherwise we will set the head (setting *p_insertPos at the same time in some cases) */
+		if (isEdge) {
+			ATOMIC_STORE_RELEASE(&(llist->head), newNode);
+
+			if (llist->tail == NULL) {
+				ATOMIC_STORE_RELEASE(&(llist->tail), newNode);
+			}
+		}
+		break;
+	case LLIST_AFTER:
+		newNode->prev = *p_insertPos;
+
+		/* Inserting after the tail node (*p_insertPos is NULL if list is empty) */
+		if (isTail(llist, *p_insertPos)) {
+			isEdge = 1;
+			newNode->next = NULL;
+
+		/* Inserting after some other node */
+		} else {
+			/* We should have more than one element */
+			assert(llist->head != llist->tail);
+
+			newNode->next = (*p_insertPos)->next;
+
+			/* The Node after the insertPos was still pointing to insertPos */
+			ATOMIC_STORE_RELEASE(&((*p_insertPos)->next->prev), newNode);
+		}
+
+		if (*p_insertPos != NULL) {
+			ATOMIC_STORE_RELEASE(&((*p_insertPos)->next), newNode);
+		}
+
+		/* See comment about head above */
+		if (isEdge) {
+			ATOMIC_STORE_RELEASE(&(llist->tail), newNode);
+
+			if (llist->head == NULL) {
+				ATOMIC_STORE_RELEASE(&(llist->head), newNode);
+			}
+		}
+		break;
+	default:
+		return -1;
+		break;
+	}
+
+	fingerOnInsert(llist, insertPos, isEdge, dir);
+	if (llist->nbNodes != LLIST_SIZE_UNKNOWN) {
+		llist->nbNodes++;
+		STAT_PEAK(llist);
+	}
+	return 0;
+}
+
+
+static int
+insertHead(LinkedList *llist, struct Node *node) {
+	return insertNode(llist, &(llist->head), node, LLIST_BEFORE);
+}
+
+
+static int
+insertTail(LinkedList *llist, struct Node *node) {
+	return insertNode(llist, &(llist->tail), node, LLIST_AFTER);
+}
+
+
+static struct Node *
+popNode(LinkedList *llist, struct Node *node) {
+	struct Node *prev, *next;
+	int b_head, b_tail;
+
+	assertList(llist);
+	assert(node != NULL);
+
+	prev = node->prev;
+	next = node->next;
+
+	/* A lone Node is both the head and the tail, so check both
+	 * before touching the list (assertList would trip in between) */
+	b_head = isHead(llist, node);
+	b_tail = isTail(llist, node);
+
+	fingerOnPop(llist, node, b_head, b_tail);
+	if (llist->index != NULL) {
+		indexRemove(llist, node);
+	}
+	if (llist->skipList != NULL) {
+		skipRemoveTower(llist, node);
+	}
+	if (llist->nbNodes != LLIST_SIZE_UNKNOWN) {
+		assert(llist->nbNodes > 0);
+		llist->nbNodes--;
+	}
+
+	/* node keeps its own links, so epoch readers which are on it can move on */
+	if (b_head) {
+		ATOMIC_STORE_RELEASE(&(llist->head), next);
+	} else {
+		ATOMIC_STORE_RELEASE(&(prev->next), next);
+	}
+
+	if (b_tail) {
+		ATOMIC_STORE_RELEASE(&(llist->tail), prev);
+	} else {
+		ATOMIC_STORE_RELEASE(&(next->prev), prev);
+	}
+
+	return node;
+}
+
+
+static size_t
+listSize(LinkedList *llist) {
+	if (llist->nbNodes == LLIST_SIZE_UNKNOWN) {
+		struct Node *node;
+
+		llist->nbNodes = 0;
+		for (node = llist->head; node != NULL; node = node->next) {
+			llist->nbNodes++;
+		}
+	}
+
+	return llist->nbNodes;
+}
+
+
+/* Nodes can only move between lists which would free them the same way
+ * and without an index (moving Nodes in or out of one isn't O(1)). Ordered
+ * lists can't take Nodes from anywhere and lists with epoch readers can't
+ * have Nodes moved under them
+ */
+static int
+canShareNodes(LinkedList *llist1, LinkedList *llist2) {
+	if (llist1 != llist2 && (llist1->index != NULL || llist2->index != NULL)) {
+		return 0;
+	}
+	if (llist1->skipList != NULL || llist2->skipList != NULL) {
+		return 0;
+	}
+	if (llist1->epochs != NULL || llist2->epochs != NULL) {
+		return 0;
+	}
+	/* Keys of one list mean nothing to the other */
+	if (llist1->f_keyNode != llist2->f_keyNode) {
+		return 0;
+	}
+
+	return llist1->pool == llist2->pool
+			&& llist1->allocator.f_alloc == llist2->allocator.f_alloc
+			&& llist1->allocator.f_free == llist2->allocator.f_free
+			&& llist1->allocator.context == llist2->allocator.context;
+}
+
+
+/* Moves to the next epoch if every reader in a read-side section already
+ * announced the current one */
+static void
+epochTryAdvance(struct EpochState *epochs) {
+	size_t current = ATOMIC_LOAD(&(epochs->globalEpoch));
+	struct s_LlistReader *reader;
+
+	for (reader = ATOMIC_LOAD(&(epochs->readers)); reader != NULL; reader = reader->next) {
+		size_t epoch = ATOMIC_LOAD(&(reader->epoch));
+
+		if (epoch != 0 && epoch != current * 2 + 1) {
+			return;
+		}
+	}
+
+	ATOMIC_STORE(&(epochs->globalEpoch), current + 1);
+}
+
+
+/* Frees the retired Nodes no reader can still be on */
+static void
+epochReclaim(LinkedList *llist) {
+	struct EpochState *epochs = llist->epochs;
+	size_t global, i, nbFreed;
+
+	epochTryAdvance(epochs);
+	global = ATOMIC_LOAD(&(epochs->globalEpoch));
+
+	for (nbFreed = 0; nbFreed < epochs->nbRetired; nbFreed++) {
+		struct RetiredNode *retired = &(epochs->retired[nbFreed]);
+
+		if (retired->epoch + 2 > global) {
+			break;
+		}
+		destroyNode(llist, retired->f_destroyNode, &(retired->node));
+	}
+
+	for (i = nbFreed; i < epochs->nbRetired; i++) {
+		epochs->retired[i - nbFreed] = epochs->retired[i];
+	}
+	epochs->nbRetired -= nbFreed;
+}
+
+
+/* Waits for every reader to be done with the Nodes retired so far and frees them */
+static void
+epochSynchronize(LinkedList *llist) {
+	struct EpochState *epochs = llist->epochs;
+	size_t target = ATOMIC_LOAD(&(epochs->globalEpoch)) + 2;
+
+	while (ATOMIC_LOAD(&(epochs->globalEpoch)) < target) {
+		epochTryAdvance(epochs);
+	}
+	epochReclaim(llist);
+	assert(epochs->nbRetired == 0);
+}
+
+
+/* Frees every retired Node and reader record, no reader may be left */
+static int
+epochDestroy(LinkedList *llist) {
+	struct EpochState *epochs = llist->epochs;
+	struct s_LlistReader *reader = epochs->readers;
+	int error = 0;
+	size_t i;
+
+	for (i = 0; i < epochs->nbRetired; i++) {
+		int destroyCode = destroyNode(llist, epochs->retired[i].f_destroyNode, &(epochs->retired[i].node));
+
+		if (destroyCode != 0) {
+			error = destroyCode;
+		}
+	}
+	if (epochs->retired != NULL) {
+		allocatorFree(&(llist->allocator), epochs->retired);
+	}
+
+	while (reader != NULL) {
+		struct s_LlistReader *next = reader->next;
+
+		assert(reader->epoch == 0);
+		allocatorFree(&defaultAllocator, reader);
+		reader = next;
+	}
+
+	allocatorFree(&(llist->allocator), epochs), llist->epochs = NULL;
+	return error;
+}
+
+
+/* Frees a popped Node (see destroyNode), or retires it if readers may be on it
+ * (f_destroyNode then runs on reclaim and this returns 0)
+ */
+static int
+releaseNode(LinkedList *llist, nodeDestroyFunc f_destroyNode, struct Node **p_node) {
+	struct EpochState *epochs = llist->epochs;
+
+	if (epochs == NULL) {
+		return destroyNode(llist, f_destroyNode, p_node);
+	}
+
+	if (epochs->nbRetired == epochs->retiredCapacity) {
+		size_t capacity = 2 * epochs->retiredCapacity + LLIST_EPOCH_BATCH;
+		struct RetiredNode *retired = allocatorAlloc(&(llist->allocator), capacity * sizeof (*retired));
+
+		/* No room to defer it, wait for the readers instead */
+		if (retired == NULL) {
+			epochSynchronize(llist);
+			return destroyNode(llist, f_destroyNode, p_node);
+		}
+
+		if (epochs->retired != NULL) {
+			size_t i;
+
+			for (i = 0; i < epochs->nbRetired; i++) {
+				retired[i] = epochs->retired[i];
+			}
+			allocatorFree(&(llist->allocator), epochs->retired);
+		}
+		epochs->retired = retired;
+		epochs->retiredCapacity = capacity;
+	}
+
+	epochs->retired[epochs->nbRetired].node = *p_node;
+	epochs->retired[epochs->nbRetired].f_destroyNode = f_destroyNode;
+	epochs->retired[epochs->nbRetired].epoch = ATOMIC_LOAD(&(epochs->globalEpoch));
+	epochs->nbRetired++;
+	*p_node = NULL;
+
+	if (epochs->nbRetired % LLIST_EPOCH_BATCH == 0) {
+		epochReclaim(llist);
+	}
+
+	return 0;
+}
+
+
+static struct Node *
+popHeadNode(LinkedList *llist) {
+	return popNode(llist, llist->head);
+}
+
+
+static struct Node *
+popTailNode(LinkedList *llist) {
+	return popNode(llist, llist->tail);
+}
+
+
+/* Points the nbCursors cursors of cursors, the finger, the index and the
+ * express lanes of llist to the copies of its Nodes, which the old Nodes'
+ * prev point to */
+static void
+followCopies(LinkedList *llist, struct Node ***cursors, size_t nbCursors) {
+	size_t i;
+
+	for (i = 0; i < nbCursors; i++) {
+		if (isUserPointerValid(cursors[i])) {
+			*cursors[i] = (*cursors[i])->prev;
+		}
+	}
+	if (llist->finger != NULL) {
+		llist->finger = llist->finger->prev;
+	}
+	if (llist->index != NULL) {
+		for (i = 0; i < llist->index->nbBuckets; i++) {
+			struct IndexEntry *entry;
+
+			for (entry = llist->index->buckets[i]; entry != NULL; entry = entry->next) {
+				entry->node = entry->node->prev;
+			}
+		}
+	}
+	/* Every tower is in the lowest lane */
+	if (llist->skipList != NULL) {
+		struct SkipTower *tower;
+
+		for (tower = llist->skipList->heads[0]; tower != NULL; tower = tower->next[0]) {
+			tower->node = tower->node->prev;
+		}
+	}
+}
+
+
+/* Moves every Node of llist into a single new block of Nodes of nodeSize
+ * bytes, in list order (see llist_compact). The block joins the list's pool,
+ * or a new pool if the list has none or shares it with lists whose Nodes are
+ * of another size. Keys are kept if the old and new Nodes both have one.
+ *
+ * Returns 0 on success, -1 on allocation failure (llist is left untouched)
+ */
+static int
+moveNodes(LinkedList *llist, size_t nodeSize, struct Node ***cursors, size_t nbCursors) {
+	struct NodeChunk *chunk = NULL;
+	struct NodePool *pool = llist->pool;
+	struct Node *node, *next;
+	int b_keepKeys = (llist->f_keyNode != NULL && nodeSize == sizeof (struct KeyedNode));
+	size_t nbNodes, i;
+
+	nbNodes = listSize(llist);
+	if (nbNodes > 0) {
+		chunk = allocatorAlloc(&(llist->allocator), chunkSize(nodeSize, nbNodes));
+		if (chunk == NULL) {
+			return -1;
+		}
+	}
+
+	if (pool == NULL || (pool->nodeSize != nodeSize && pool->refCount > 1)) {
+		pool = new_pool(&(llist->allocator), (pool != NULL) ? pool->chunkNodes : LLIST_DEFAULT_CHUNK_NODES, nodeSize);
+		if (pool == NULL) {
+			allocatorFree(&(llist->allocator), chunk);
+			return -1;
+		}
+	}
+
+	/* Until the old Nodes are released, their prev points to their copy */
+	for (i = 0, node = llist->head; node != NULL; i++, node = node->next) {
+		struct Node *copy = chunkNode(chunk, nodeSize, i);
+
+		copy->prev = (i > 0) ? chunkNode(chunk, nodeSize, i - 1) : NULL;
+		copy->next = (i + 1 < nbNodes) ? chunkNode(chunk, nodeSize, i + 1) : NULL;
+		copy->data = node->data;
+		if (b_keepKeys) {
+			NODE_KEY(copy) = NODE_KEY(node);
+		}
+		node->prev = copy;
+	}
+	assert(i == nbNodes);
+	followCopies(llist, cursors, nbCursors);
+
+	if (pool == llist->pool && pool->refCount == 1) {
+		struct NodeChunk *oldChunk = pool->chunks;
+
+		while (oldChunk != NULL) {
+			struct NodeChunk *nextChunk = oldChunk->next;
+
+			allocatorFree(&(llist->allocator), oldChunk);
+			oldChunk = nextChunk;
+		}
+		pool->chunks = NULL;
+		pool->freeNodes = NULL;
+		pool->nodeSize = nodeSize;
+	} else {
+		for (node = llist->head; node != NULL; node = next) {
+			next = node->next;
+			if (llist->pool != NULL) {
+				poolFreeNode(llist->pool, node);
+			} else {
+				allocatorFree(&(llist->allocator), node);
+			}
+		}
+		if (llist->pool != NULL && pool != llist->pool) {
+			poolRelease(&(llist->allocator), &(llist->pool));
+		}
+	}
+
+	/* The block can't take new Nodes, so it mustn't be the chunk being carved */
+	if (chunk != NULL && pool->chunks == NULL) {
+		chunk->next = NULL;
+		pool->chunks = chunk;
+		pool->nbCarved = pool->chunkNodes;
+	} else if (chunk != NULL) {
+		chunk->next = pool->chunks->next;
+		pool->chunks->next = chunk;
+	}
+
+	llist->pool = pool;
+	llist->head = (nbNodes > 0) ? chunkNode(chunk, nodeSize, 0) : NULL;
+	llist->tail = (nbNodes > 0) ? chunkNode(chunk, nodeSize, nbNodes - 1) : NULL;
+	llist->nbNodes = nbNodes;
+	return 0;
+}
+
+
+/* Replaces every Node of the unpooled llist by a copy of nodeSize bytes,
+ * allocated one by one like new_node does. Keys are kept if the old and new
+ * Nodes both have one
+ *
+ * Returns 0 on success, -1 on allocation failure (llist is left untouched)
+ */
+static int
+reallocNodes(LinkedList *llist, size_t nodeSize) {
+	struct Node *node, *next, *prevCopy = NULL;
+	int b_keepKeys = (llist->f_keyNode != NULL && nodeSize == sizeof (struct KeyedNode));
+
+	assert(llist->pool == NULL);
+
+	/* Until the old Nodes are released, their prev points to their copy */
+	for (node = llist->head; node != NULL; node = node->next) {
+		struct Node *copy = allocatorAlloc(&(llist->allocator), nodeSize);
+
+		if (copy == NULL) {
+			struct Node *prev = NULL;
+
+			/* Old prev pointers are the previous Nodes, put them back */
+			for (next = llist->head; next != node; next = next->next) {
+				allocatorFree(&(llist->allocator), next->prev);
+				next->prev = prev;
+				prev = next;
+			}
+			return -1;
+		}
+		copy->prev = prevCopy;
+		copy->next = NULL;
+		copy->data = node->data;
+		if (b_keepKeys) {
+			NODE_KEY(copy) = NODE_KEY(node);
+		}
+		if (prevCopy != NULL) {
+			prevCopy->next = copy;
+		}
+		prevCopy = copy;
+		node->prev = copy;
+	}
+	followCopies(llist, NULL, 0);
+
+	node = llist->head;
+	llist->head = (node != NULL) ? node->prev : NULL;
+	llist->tail = prevCopy;
+	while (node != NULL) {
+		next = node->next;
+		allocatorFree(&(llist->allocator), node);
+		node = next;
+	}
+	return 0;
+}
+
+
+/* === END Internal functions === */
+
+
+
+LinkedList *
+llist_new(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode) {
+	LinkedList *llist = llist_newWithAllocator(f_destroyNode, f_cmpNode, NULL);
+
+	assert(llist != NULL);
+
+	return llist;
+}
+
+
+/*
+ * llist_newWithAllocator
+ *
+ * Same as llist_new, but the list and its Nodes are allocated through
+ * allocator (which is copied, NULL means malloc/free). If allocator->f_free
+ * is NULL, Nodes are never freed one by one and llist_destroy doesn't walk
+ * the list unless there's a f_destroyNode to call
+ */
+LinkedList *
+llist_newWithAllocator(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode, const LlistAllocator *allocator) {
+	LinkedList *llist;
+
+	if (allocator == NULL) {
+		allocator = &defaultAllocator;
+	} else if (allocator->f_alloc == NULL) {
+		return NULL;
+	}
+
+	llist = allocatorAlloc(allocator, sizeof (*llist));
+	if (llist != NULL) {
+		llist->head = NULL;
+		llist->tail = NULL;
 
 		llist->f_destroyNode = f_destroyNode;
 		llist->f_cmpNode = f_cmpNode;
+		llist->allocator = *allocator;
+		llist->pool = NULL;
+		llist->nbNodes = 0;
+		llist->finger = NULL;
+		llist->fingerIndex = 0;
+		llist->index = NULL;
+		llist->skipList = NULL;
+		llist->epochs = NULL;
+		llist->f_keyNode = NULL;
+		llist->b_exactKey = 0;
+#ifdef LLIST_STATS
+		memset(&(llist->stats), 0, sizeof (llist->stats));
+#endif
+	}
+
+	return llist;
+}
+
+
+/*
+ * llist_newPooled
+ *
+ * Same as llist_new, but Nodes are carved from chunks of chunkNodes Nodes
+ * (0 for a default size) and recycled internally instead of going through
+ * malloc/free every time. The chunks are only released by llist_destroy
+ *
+ * Returns NULL on allocation failure or if a chunk's size overflows size_t
+ */
+LinkedList *
+llist_newPooled(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode, size_t chunkNodes) {
+	LinkedList *llist;
+
+	/* Keyed Nodes are the largest the pool can get (see llist_setKeyFunc) */
+	if (chunkNodes > ((size_t)-1 - offsetof (struct NodeChunk, nodes)) / sizeof (struct KeyedNode)) {
+		return NULL;
+	}
+
+	llist = llist_new(f_destroyNode, f_cmpNode);
+	if (llist == NULL) {
+		return NULL;
+	}
+
+	llist->pool = new_pool(&(llist->allocator), (chunkNodes > 0) ? chunkNodes : LLIST_DEFAULT_CHUNK_NODES,
+			sizeof (struct Node));
+	if (llist->pool == NULL) {
+		llist_destroy(&llist);
+		return NULL;
+	}
+
+	return llist;
+}
+
+
+/*
+ * llist_newOrdered
+ *
+ * Creates a list which is always sorted by f_cmpNode: data goes in with
+ * llist_insertSorted only (llist_insertHead, llist_insertTail and
+ * llistCursor_insertData fail). Express lanes built over the Nodes make
+ * llist_insertSorted, llist_lowerBound and llist_upperBound O(log n) while
+ * cursors walk the list as usual. Removing a Node also costs O(log n)
+ */
+LinkedList *
+llist_newOrdered(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode) {
+	LinkedList *llist = llist_new(f_destroyNode, f_cmpNode);
+	size_t level;
+
+	if (llist == NULL) {
+		return NULL;
+	}
+
+	llist->skipList = allocatorAlloc(&(llist->allocator), sizeof (*llist->skipList));
+	if (llist->skipList == NULL) {
+		llist_destroy(&llist);
+		return NULL;
+	}
+
+	for (level = 0; level < LLIST_SKIP_MAX_LEVEL; level++) {
+		llist->skipList->heads[level] = NULL;
+	}
+	llist->skipList->height = 0;
+	llist->skipList->seed = 2463534242UL;
+
+	return llist;
+}
+
+
+/*
+ * llist_enableIndex
+ *
+ * Maintains a hash index of the list's data (f_hashNode must give equal hashes
+ * to data that f_cmpNode considers equal) so that llist_countMatch runs in
+ * O(matches) and llistCursor_find returns in O(1) when nothing matches or when
+ * searching the whole list for data present once. Enabling it on a non-empty
+ * list indexes its current data. Indexed lists can't exchange Nodes with other
+ * lists (llist_splice, llist_concat and llist_splitAt fail)
+ *
+ * Returns 0 on success, -1 on allocation failure (the list is then unindexed)
+ */
+int
+llist_enableIndex(LinkedList *llist, nodeHashFunc f_hashNode) {
+	struct NodeIndex *index;
+	struct Node *node;
+	size_t nbBuckets = LLIST_INDEX_MIN_BUCKETS;
+
+	assertList(llist);
+
+	if (f_hashNode == NULL) {
+		return -2;
+	}
+
+	llist_disableIndex(llist);
+
+	index = allocatorAlloc(&(llist->allocator), sizeof (*index));
+	if (index == NULL) {
+		return -1;
+	}
+
+	while (nbBuckets < listSize(llist)) {
+		nbBuckets *= 2;
+	}
+
+	index->f_hashNode = f_hashNode;
+	index->buckets = NULL;
+	index->nbBuckets = 0;
+	index->nbEntries = 0;
+	index->freeEntries = NULL;
+	llist->index = index;
+
+	indexResize(&(llist->allocator), index, nbBuckets);
+	if (index->buckets == NULL) {
+		llist_disableIndex(llist);
+		return -1;
+	}
+
+	for (node = llist->head; node != NULL; node = node->next) {
+		if (indexAdd(llist, node) != 0) {
+			llist_disableIndex(llist);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+int
+llist_disableIndex(LinkedList *llist) {
+	assertList(llist);
+
+	if (llist->index != NULL) {
+		indexDestroy(&(llist->allocator), &(llist->index));
+	}
+	return 0;
+}
+
+
+/*
+ * llist_setKeyFunc
+ *
+ * Has every Node keep f_keyNode(data) next to its data so that searches
+ * (llistCursor_find, llist_countMatch...) skip Nodes whose key differs from
+ * the searched data's without calling f_cmpNode or touching their data.
+ * f_keyNode must give equal keys to data that f_cmpNode considers equal. If
+ * b_exactKey, equal keys also mean equal data and f_cmpNode isn't called at
+ * all by searches. Keys of the current Nodes are computed right away, NULL
+ * removes the key function.
+ *
+ * Nodes of lists with a key function are larger, so adding or removing it
+ * moves the Nodes of llist to new ones (cursors on llist become invalid). A
+ * pooled list sharing its pool gets a pool of its own for them.
+ *
+ * Lists can only exchange Nodes with lists using the same key function
+ * Returns 0 on success, -1 on allocation failure (llist is left untouched),
+ * -2 if llist has epochs enabled and the key function is added or removed
+ */
+int
+llist_setKeyFunc(LinkedList *llist, nodeKeyFunc f_keyNode, int b_exactKey) {
+	size_t nodeSize = nodeSizeOf(f_keyNode);
+	struct Node *node;
+
+	assertList(llist);
+
+	if (nodeSize != nodeSizeOf(llist->f_keyNode)) {
+		int ret;
+
+		/* Readers could be on the old Nodes */
+		if (llist->epochs != NULL) {
+			return -2;
+		}
+		ret = (llist->pool != NULL) ? moveNodes(llist, nodeSize, NULL, 0) : reallocNodes(llist, nodeSize);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	llist->f_keyNode = f_keyNode;
+	llist->b_exactKey = (f_keyNode != NULL && b_exactKey);
+	if (f_keyNode != NULL) {
+		for (node = llist->head; node != NULL; node = node->next) {
+			NODE_KEY(node) = f_keyNode(node->data);
+		}
+	}
+	return 0;
+}
+
+
+/*
+ * llist_enableEpochs
+ *
+ * Lets threads walk the list (llistCursor_getHead/getTail/getNext/getPrev and
+ * llistCursor_getData) without any lock while a writer inserts and removes
+ * Nodes. Readers get a LlistReader each (llist_newReader) and only look at the
+ * list between llist_readBegin and llist_readEnd, which just announce the
+ * reader's epoch in its own record.
+ *
+ * Removed Nodes are retired instead of freed, and freed (with their data for
+ * llist_removeNode) once no reader can be on them anymore. A cursor stays
+ * usable until llist_readEnd even if its Node gets removed meanwhile.
+ *
+ * Writers still need to be serialized among themselves, and only inserting
+ * and removing is safe with readers around: sorting relinks every Node and
+ * must happen with no reader inside. Lists with epochs can't give or take
+ * Nodes (splice, concat, splitAt).
+ *
+ * Returns 0 on success, -1 on allocation failure
+ */
+int
+llist_enableEpochs(LinkedList *llist) {
+	assertList(llist);
+
+	if (llist->epochs != NULL) {
+		return 0;
+	}
+
+	llist->epochs = allocatorAlloc(&(llist->allocator), sizeof (*llist->epochs));
+	if (llist->epochs == NULL) {
+		return -1;
+	}
+	llist->epochs->globalEpoch = 1;
+	llist->epochs->readers = NULL;
+	llist->epochs->retired = NULL;
+	llist->epochs->nbRetired = 0;
+	llist->epochs->retiredCapacity = 0;
+
+	return 0;
+}
+
+
+/* Thread-safe, records of destroyed readers are reused
+ * Returns NULL if epochs aren't enabled or on allocation failure
+ */
+LlistReader *
+llist_newReader(LinkedList *llist) {
+	struct EpochState *epochs = llist->epochs;
+	struct s_LlistReader *reader;
+	struct s_LlistReader *head;
+
+	if (epochs == NULL) {
+		return NULL;
+	}
+
+	for (reader = ATOMIC_LOAD(&(epochs->readers)); reader != NULL; reader = reader->next) {
+		int unused = 0;
+
+		if (ATOMIC_LOAD_RELAXED(&(reader->b_inUse)) == 0 && ATOMIC_CAS(&(reader->b_inUse), &unused, 1)) {
+			return reader;
+		}
+	}
+
+	/* Readers live in other threads, so they don't use the list's allocator */
+	reader = allocatorAlloc(&defaultAllocator, sizeof (*reader));
+	if (reader == NULL) {
+		return NULL;
+	}
+	reader->epoch = 0;
+	reader->b_inUse = 1;
+
+	head = ATOMIC_LOAD(&(epochs->readers));
+	do {
+		reader->next = head;
+	} while (!ATOMIC_CAS(&(epochs->readers), &head, reader));
+
+	return reader;
+}
+
+
+/* Must be outside of a read-side section */
+int
+llist_destroyReader(LlistReader **p_reader) {
+	if (p_reader == NULL || *p_reader == NULL) {
+		return 0;
+	}
+	assert((*p_reader)->epoch == 0);
+
+	ATOMIC_STORE_RELEASE(&((*p_reader)->b_inUse), 0), *p_reader = NULL;
+	return 0;
+}
+
+
+void
+llist_readBegin(LinkedList *llist, LlistReader *reader) {
+	size_t epoch = ATOMIC_LOAD(&(llist->epochs->globalEpoch));
+
+	ATOMIC_STORE_RELAXED(&(reader->epoch), epoch * 2 + 1);
+	/* The announcement must be visible before the first Node gets read */
+	ATOMIC_FENCE();
+}
+
+
+void
+llist_readEnd(LinkedList *llist, LlistReader *reader) {
+	(void)llist;
+	ATOMIC_STORE_RELEASE(&(reader->epoch), (size_t)0);
+}
+
+
+/* Writer side: waits until the readers are done with every removed Node and
+ * frees them. Must not be called from inside a read-side section
+ */
+int
+llist_synchronize(LinkedList *llist) {
+	assertList(llist);
+
+	if (llist->epochs == NULL) {
+		return -1;
+	}
+
+	epochSynchronize(llist);
+	return 0;
+}
+
+
+static int
+destroyList(LinkedList **p_llist) {
+	struct Node *node;
+	int error = 0;
+	LinkedList *llist;
+
+	if (p_llist == NULL) {
+		return 0;
+	}
+
+	assertList(*p_llist);
+
+	llist = *p_llist;
+
+	if (llist->index != NULL) {
+		indexDestroy(&(llist->allocator), &(llist->index));
+	}
+	if (llist->skipList != NULL) {
+		skipDestroy(&(llist->allocator), &(llist->skipList));
+	}
+	if (llist->epochs != NULL) {
+		error = epochDestroy(llist);
+	}
+
+	/* Pooled Nodes are released with their chunks (unless another list still
+	 * uses the pool) and arena Nodes aren't released at all, so only the data
+	 * needs a walk */
+	if ((llist->pool != NULL && llist->pool->refCount == 1) || llist->allocator.f_free == NULL) {
+		if (llist->f_destroyNode != NULL) {
+			for (node = llist->head; node != NULL; node = node->next) {
+				int destroyCode = llist->f_destroyNode(node->data);
+
+				if (destroyCode != 0) {
+					error = destroyCode;
+				}
+			}
+		}
+		llist->head = llist->tail = NULL;
+		llist->nbNodes = 0;
+	}
+
+	while (llist->head != NULL) {
+		int destroyCode;
+
+		assert(llist->nbNodes > 0);
+		node = popHeadNode(llist);
+		destroyCode = destroyNode(llist, llist->f_destroyNode, &node);
+		if (destroyCode != 0) {
+			error = destroyCode;
+		}
+	}
+	assert(llist->nbNodes == 0 || llist->nbNodes == LLIST_SIZE_UNKNOWN);
+
+	if (llist->pool != NULL) {
+		poolRelease(&(llist->allocator), &(llist->pool));
+	}
+
+	allocatorFree(&(llist->allocator), llist), *p_llist = llist = NULL;
+	return error;
+}
+
+
+int
+llist_destroy(LinkedList **p_llist) {
+	int result;
+
+	TRACE_CALL(LLIST_OP_DESTROY, (p_llist != NULL) ? *p_llist : NULL, result = destroyList(p_llist));
+	return result;
+}
+
+
+int
+llistCursor_isTail(LinkedList *llist, struct Node **cursor) {
+	struct Node *node;
+
+	if (!isUserPointerValid(cursor)) {
+		return -1;
+	}
+	node = *cursor;
+	return !isTail(llist, node);
+}
+
+
+int
+llistCursor_isHead(LinkedList *llist, struct Node **cursor) {
+	struct Node *node;
+
+	if (!isUserPointerValid(cursor)) {
+		return -1;
+	}
+	node = *cursor;
+
+	return !isHead(llist, node);
+}
+
+
+/* Returns 0 on success, negative number on failure (-2 for ordered lists) */
+static int
+insertHeadData(LinkedList *llist, void *data) {
+	struct Node *newNode;
+
+	if (llist->skipList != NULL) {
+		return -2;
+	}
+
+	newNode = new_node(llist, data);
+	if (newNode == NULL) {
+		return -1;
+	}
+	if (insertHead(llist, newNode) != 0) {
+		destroyNode(llist, NULL, &newNode);
+		return -1;
+	}
+	return 0;
+}
+
+
+int
+llist_insertHead(LinkedList *llist, void *data) {
+	int result;
+
+	TRACE_CALL(LLIST_OP_INSERT_HEAD, llist, result = insertHeadData(llist, data));
+	return result;
+}
+
+
+/* Returns 0 on success, negative number on failure (-2 for ordered lists) */
+static int
+insertTailData(LinkedList *llist, void *data) {
+	struct Node *newNode;
+
+	if (llist->skipList != NULL) {
+		return -2;
+	}
+
+	newNode = new_node(llist, data);
+	if (newNode == NULL) {
+		return -1;
+	}
+	if (insertTail(llist, newNode) != 0) {
+		destroyNode(llist, NULL, &newNode);
+		return -1;
+	}
+	return 0;
+}
+
+
+int
+llist_insertTail(LinkedList *llist, void *data) {
+	int result;
+
+	TRACE_CALL(LLIST_OP_INSERT_TAIL, llist, result = insertTailData(llist, data));
+	return result;
+}
+
+
+/* Returns 0 on success, negative number on failure (-4 for ordered lists) */
+static int
+insertCursorData(LinkedList *llist, struct Node **cursor, void *data, LlistDirection dir) {
+	struct Node *newNode;
+
+	if (!isUserPointerValid(cursor)) {
+		return -2;
+	}
+	if (llist->skipList != NULL) {
+		return -4;
+	}
+
+	newNode = new_node(llist, data);
+	if (newNode == NULL) {
+		return -1;
+	}
+
+	if (insertNode(llist, cursor, newNode, dir) != 0) {
+		destroyNode(llist, NULL, &newNode);
+		return -3;
+	}
+	return 0;
+}
+
+
+int
+llistCursor_insertData(LinkedList *llist, struct Node **cursor, void *data, LlistDirection dir) {
+	int result;
+
+	TRACE_CALL(LLIST_OP_INSERT_DATA, llist, result = insertCursorData(llist, cursor, data, dir));
+	return result;
+}
+
+
+/* Caller is responsible of freeing the data returned */
+static void *
+popCursorNode(LinkedList *llist, struct Node **cursor) {
+	void *data;
+	struct Node *node;
+
+	if (!isUserPointerValid(cursor)) {
+		return NULL;
+	}
+	node = popNode(llist, *cursor);
+	assert(node == *cursor);
+
+	data = node->data;
+	releaseNode(llist, NULL, cursor);
+	return data;
+}
+
+
+void *
+llist_popNode(LinkedList *llist, struct Node **cursor) {
+	void *result;
+
+	TRACE_CALL(LLIST_OP_POP_NODE, llist, result = popCursorNode(llist, cursor));
+	return result;
+}
+
+
+static int
+removeCursorNode(LinkedList *llist, struct Node **cursor) {
+	struct Node *node;
+
+	assertList(llist);
+	if (!isUserPointerValid(cursor)) {
+		return -1;
+	}
+
+	node = popNode(llist, *cursor);
+	assert(node == *cursor);
+
+	return releaseNode(llist, llist->f_destroyNode, cursor);
+}
+
+
+int
+llist_removeNode(LinkedList *llist, struct Node **cursor) {
+	int result;
+
+	TRACE_CALL(LLIST_OP_REMOVE_NODE, llist, result = removeCursorNode(llist, cursor));
+	return result;
+}
+
+
+/* Returns NULL in case of error (or if the list is empty)
+ * Caller is responsible of freeing data
+ */
+static void *
+popHeadData(LinkedList *llist) {
+	struct Node *node;
+	void *data;
+
+	assertList(llist);
+
+	if (llist == NULL || llist->head == NULL) {
+		return NULL;
+	}
+
+	node = popHeadNode(llist);
+	data = node->data;
+	releaseNode(llist, NULL, &node);
+	return data;
+}
+
+
+void *
+llist_popHead(LinkedList *llist) {
+	void *result;
+
+	TRACE_CALL(LLIST_OP_POP_HEAD, llist, result = popHeadData(llist));
+	return result;
+}
+
+
+/* Returns NULL in case of error (or if the list is empty)
+ * Caller is responsible of freeing data
+ */
+static void *
+popTailData(LinkedList *llist) {
+	struct Node *node;
+	void *data;
+
+	assertList(llist);
+
+	if (llist == NULL || llist->tail == NULL) {
+		return NULL;
+	}
+
+	node = popTailNode(llist);
+	data = node->data;
+	releaseNode(llist, NULL, &node);
+	return data;
+}
+
+
+void *
+llist_popTail(LinkedList *llist) {
+	void *result;
+
+	TRACE_CALL(LLIST_OP_POP_TAIL, llist, result = popTailData(llist));
+	return result;
+}
+
+
+/*
+ * llist_countMatch
+ *
+ * llist: LinkedList to search into
+ * data: data to match such that llist->f_cmpNode(nodeData, data) == 0
+ */
+static size_t
+countMatch(LinkedList *llist, void *data) {
+	struct Node *node;
+	size_t count = 0;
+	unsigned long key = probeKey(llist, data);
+
+	if (llist->index != NULL) {
+		size_t hash = llist->index->f_hashNode(data);
+		struct IndexEntry *entry;
+
+		for (entry = *indexBucket(llist->index, hash); entry != NULL; entry = entry->next) {
+			STAT_ADD(STATS_OF(llist), nbTraversed, 1);
+			if (entry->hash == hash && nodeMatches(llist, entry->node, data, key)) {
+				count++;
+			}
+		}
+		return count;
+	}
+
+	for (node = llist->head; node != NULL; node = node->next) {
+		STAT_ADD(STATS_OF(llist), nbTraversed, 1);
+		if (nodeMatches(llist, node, data, key)) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+
+size_t
+llist_countMatch(LinkedList *llist, void *data) {
+	size_t result;
+
+	TRACE_CALL(LLIST_OP_COUNT_MATCH, llist, result = countMatch(llist, data));
+	return result;
+}
+
+
+/* Sets *p_match to the only Node matching data (NULL if there is none)
+ * Returns 0, or -1 if several Nodes match
+ */
+static int
+indexFindUnique(LinkedList *llist, void *data, struct Node **p_match) {
+	size_t hash = llist->index->f_hashNode(data);
+	unsigned long key = probeKey(llist, data);
+	struct IndexEntry *entry;
+
+	*p_match = NULL;
+	for (entry = *indexBucket(llist->index, hash); entry != NULL; entry = entry->next) {
+		STAT_ADD(STATS_OF(llist), nbTraversed, 1);
+		if (entry->hash == hash && nodeMatches(llist, entry->node, data, key)) {
+			if (*p_match != NULL) {
+				return -1;
+			}
+			*p_match = entry->node;
+		}
+	}
+
+	return 0;
+}
+
+
+int
+llistCursor_findNext(LinkedList *llist, struct Node **cursor, void *data) {
+	if (llistCursor_getNext(llist, cursor) != 0) {
+		return -4;
+	}
+	return llistCursor_find(llist, cursor, data, LLIST_AFTER);
+}
+
+
+int
+llistCursor_findPrev(LinkedList *llist, struct Node **cursor, void *data) {
+	if (llistCursor_getPrev(llist, cursor) != 0) {
+		return -4;
+	}
+	return llistCursor_find(llist, cursor, data, LLIST_BEFORE);
+}
+
+
+/*
+ * llistCursor_find
+ *
+ * llist: LinkedList to search into
+ * searchBase: the Node to start the search at
+ * data: data to match such that llist->f_cmpNode(data, nodeData) == 0
+ * searchDir: the direction to search in
+ */
+static int
+findData(LinkedList *llist, struct Node **cursor, void *data, LlistDirection searchDir) {
+	struct Node *node;
+	unsigned long key;
+
+	assertList(llist);
+	if (!isUserPointerValid(cursor)) {
+		return -2;
+	}
+
+	/* The index can't tell which matches are on the searched side of cursor,
+	 * only whether there are none and if a whole-list search has a single one */
+	if (llist->index != NULL && (searchDir == LLIST_BEFORE || searchDir == LLIST_AFTER)) {
+		struct Node *match = NULL;
+
+		if (indexFindUnique(llist, data, &match) == 0) {
+			if (match == NULL) {
+				return -1;
+			}
+			if ((searchDir == LLIST_AFTER && *cursor == llist->head)
+					|| (searchDir == LLIST_BEFORE && *cursor == llist->tail)) {
+				*cursor = match;
+				return 0;
+			}
+		}
+	}
+
+	key = probeKey(llist, data);
+	for (node = *cursor; node != NULL; ) {
+		STAT_ADD(STATS_OF(llist), nbTraversed, 1);
+		if (nodeMatches(llist, node, data, key)) {
+			*cursor = node;
+			return 0;
+		}
+
+		switch (searchDir) {
+		case LLIST_BEFORE:
+
+			node = node->prev;
+			break;
+		case LLIST_AFTER:
+
+			node = node->next;
+			break;
+		default:
+			return -3;
+		}
+	}
+
+	assert(node == NULL);
+	return -1;
+}
+
+
+int
+llistCursor_find(LinkedList *llist, struct Node **cursor, void *data, LlistDirection searchDir) {
+	int result;
+
+	TRACE_CALL(LLIST_OP_FIND, llist, result = findData(llist, cursor, data, searchDir));
+	return result;
+}
+
+
+static void
+swapNodes(LinkedList *llist, struct Node *node1, struct Node *node2) {
+	int b_neighbours;
+	struct Node
+			*prev1,
+			*next1,
+			*prev2,
+			*next2;
+
+	assert(node1 != NULL && node2 != NULL);
+
+	/* If both nodes are next to each other, make sure
+	 * node1 refers to the first one */
+	if (node1->prev == node2) {
+		struct Node *tmp = node1;
+		node1 = node2;
+		node2 = tmp;
+	}
+
+	/* Sync test */
+	assert( ! ((node1->next == node2) ^ (node2->prev == node1)));
+
+
+	prev1 = node1->prev;
+	next1 = node1->next;
+	next2 = node2->next;
+	prev2 = node2->prev;
+
+	b_neighbours = (node1->next == node2);
+
+	if (prev1 != NULL) {
+		prev1->next = node2;
+	}
+	if (next2 != NULL) {
+		next2->prev = node1;
+	}
+
+	if (b_neighbours) {
+		node1->prev = node2;
+		node2->next = node1;
+
+	} else {
+		if (next1 != NULL) {
+			next1->prev = node2;
+		}
+		if (prev2 != NULL) {
+			prev2->next = node1;
+		}
+
+		node1->prev = prev2;
+		node2->next = next1;
+	}
+
+	node2->prev = prev1;
+	node1->next = next2;
+
+
+	if (llist->head == node1) {
+		llist->head = node2;
+	} else if (llist->head == node2) {
+		llist->head = node1;
+	}
+
+	if (llist->tail == node1) {
+		llist->tail = node2;
+	} else if (llist->tail == node2) {
+		llist->tail = node1;
+	}
+}
+
+
+/* Merges two sorted chains linked through next only (prev is ignored)
+ * On equal elements, left wins so that the merge is stable
+ * A Node of right going before Nodes of left counts as a swap in stats
+ */
+static struct Node *
+mergeChains(nodeCmpFunc f_cmpNode, LlistStats *stats, struct Node *left, struct Node *right) {
+	struct Node *head = NULL;
+	struct Node **p_link = &head;
+
+	(void)stats;
+	while (left != NULL && right != NULL) {
+		STAT_ADD(stats, nbCmps, 1);
+		if (f_cmpNode(left->data, right->data) <= 0) {
+			*p_link = left;
+			left = left->next;
+		} else {
+			STAT_ADD(stats, nbSwaps, 1);
+			*p_link = right;
+			right = right->next;
+		}
+		p_link = &((*p_link)->next);
+	}
+	*p_link = (left != NULL) ? left : right;
+
+	return head;
+}
+
+
+/* Merges adjacent runs pairwise until a single one remains, O(n log(nbRuns))
+ * Each run is sorted and NULL-terminated through next, runs are chained to
+ * one another through the prev pointer of their first Node (NULL after the
+ * last one). Earlier runs win ties, so that the merge is stable
+ *
+ * Returns the merged chain, prev pointers are left inconsistent
+ */
+static struct Node *
+mergeRuns(nodeCmpFunc f_cmpNode, LlistStats *stats, struct Node *runs) {
+	while (runs != NULL && runs->prev != NULL) {
+		struct Node *merged = NULL;
+		struct Node **p_merged = &merged;
+		struct Node *run = runs;
+
+		while (run != NULL) {
+			struct Node *left = run;
+			struct Node *right = left->prev;
+
+			if (right == NULL) {
+				run = NULL;
+			} else {
+				run = right->prev;
+				left = mergeChains(f_cmpNode, stats, left, right);
+			}
+
+			*p_merged = left;
+			p_merged = &(left->prev);
+		}
+		*p_merged = NULL;
+
+		runs = merged;
+	}
+
+	return runs;
+}
+
+
+/* Bottom-up natural merge sort of a NULL-terminated chain
+ *
+ * The chain is first cut into its already sorted runs (so a sorted chain costs
+ * a single pass), chained for mergeRuns through the prev pointer of their
+ * first Node, which is free to use since prev pointers are rebuilt by the
+ * caller anyway.
+ *
+ * Returns the new head, prev pointers are left inconsistent
+ */
+static struct Node *
+sortChain(nodeCmpFunc f_cmpNode, LlistStats *stats, struct Node *head) {
+	struct Node *runs = NULL;
+	struct Node **p_lastRun = &runs;
+	struct Node *node = head;
+
+	while (node != NULL) {
+		struct Node *runHead = node;
+
+		while (node->next != NULL && (STAT_ADD(stats, nbCmps, 1), f_cmpNode(node->data, node->next->data) <= 0)) {
+			node = node->next;
+		}
+
+		*p_lastRun = runHead;
+		p_lastRun = &(runHead->prev);
+
+		runHead = node->next;
+		node->next = NULL;
+		node = runHead;
+	}
+	*p_lastRun = NULL;
+
+	return mergeRuns(f_cmpNode, stats, runs);
+}
+
+
+/* A segment of llist_parallelSort: chain gets sorted, or merged with other
+ * (which follows it in the list, so that ties keep their order) */
+struct SortTask {
+	nodeCmpFunc f_cmpNode;
+	LlistStats stats;
+	struct Node *chain;
+	struct Node *other;
+	pthread_t thread;
+	int b_threaded;
+};
+
+
+static void *
+runSortTask(void *arg) {
+	struct SortTask *task = arg;
+
+	if (task->other == NULL) {
+		task->chain = sortChain(task->f_cmpNode, &(task->stats), task->chain);
+	} else {
+		task->chain = mergeChains(task->f_cmpNode, &(task->stats), task->chain, task->other);
+		task->other = NULL;
+	}
+	return NULL;
+}
+
+
+/* Gives every task but the last its own thread, the calling thread runs the
+ * last one (and any task a thread couldn't be created for) */
+static void
+runSortTasks(struct SortTask *tasks, size_t nbTasks) {
+	size_t i;
+
+	for (i = 0; i + 1 < nbTasks; i++) {
+		tasks[i].b_threaded = (pthread_create(&(tasks[i].thread), NULL, runSortTask, &tasks[i]) == 0);
+	}
+	runSortTask(&tasks[nbTasks - 1]);
+
+	for (i = 0; i + 1 < nbTasks; i++) {
+		if (tasks[i].b_threaded) {
+			pthread_join(tasks[i].thread, NULL);
+		} else {
+			runSortTask(&tasks[i]);
+		}
+	}
+}
+
+
+/* Rebuilds prev pointers, head and tail from a NULL-terminated chain */
+static void
+relinkChain(LinkedList *llist, struct Node *head) {
+	struct Node *node, *prev = NULL;
+
+	for (node = head; node != NULL; prev = node, node = node->next) {
+		node->prev = prev;
+	}
+
+	llist->head = head;
+	llist->tail = prev;
+}
+
+
+/*
+ * llist_mergeSort
+ *
+ * Stable O(n log n) sort using llist->f_cmpNode. Only relinks Nodes (data pointers
+ * don't move and no memory is allocated) and runs in linear time on lists that
+ * are already sorted or made of a few sorted runs
+ */
+static int
+mergeSort(LinkedList *llist) {
+	assertList(llist);
+
+	if (llist->head == NULL || llist->skipList != NULL) {
+		return 0;
+	}
+
+	llist->finger = NULL;
+	relinkChain(llist, sortChain(llist->f_cmpNode, STATS_OF(llist), llist->head));
+	return 0;
+}
+
+
+int
+llist_mergeSort(LinkedList *llist) {
+	int result;
+
+	TRACE_CALL(LLIST_OP_MERGE_SORT, llist, result = mergeSort(llist));
+	return result;
+}
+
+
+/*
+ * llist_parallelSort
+ *
+ * Same result as llist_mergeSort (stable, using llist->f_cmpNode, which must
+ * be safe to call from several threads at once), but the list is cut into
+ * nbThreads segments of the same size which are sorted on their own threads,
+ * then adjacent segments are merged pairwise, each pair on its own thread.
+ * Small lists don't get more threads than they are worth.
+ *
+ * Returns 0 on success (falling back to llist_mergeSort when the threads'
+ * bookkeeping can't be allocated)
+ */
+static int
+parallelSort(LinkedList *llist, size_t nbThreads) {
+	struct SortTask *tasks;
+	struct Node *node;
+	size_t nbNodes, nbTasks, i;
+
+	assertList(llist);
+
+	if (llist->head == NULL || llist->skipList != NULL) {
+		return 0;
+	}
+
+	nbNodes = listSize(llist);
+	if (nbThreads > nbNodes / LLIST_PARALLEL_MIN_NODES) {
+		nbThreads = nbNodes / LLIST_PARALLEL_MIN_NODES;
+	}
+	if (nbThreads <= 1) {
+		return mergeSort(llist);
+	}
+
+	tasks = allocatorAlloc(&(llist->allocator), nbThreads * sizeof (*tasks));
+	if (tasks == NULL) {
+		return mergeSort(llist);
+	}
+
+	/* Cut the list in NULL-terminated segments, the first ones taking the remainder */
+	node = llist->head;
+	for (i = 0; i < nbThreads; i++) {
+		size_t segmentNodes = nbNodes / nbThreads + (i < nbNodes % nbThreads);
+		struct Node *last = node;
+
+		tasks[i].f_cmpNode = llist->f_cmpNode;
+		memset(&(tasks[i].stats), 0, sizeof (tasks[i].stats));
+		tasks[i].chain = node;
+		tasks[i].other = NULL;
+
+		while (--segmentNodes > 0) {
+			last = last->next;
+		}
+		node = last->next;
+		last->next = NULL;
+	}
+	assert(node == NULL);
+
+	runSortTasks(tasks, nbThreads);
+
+	for (nbTasks = nbThreads; nbTasks > 1; nbTasks = (nbTasks + 1) / 2) {
+		for (i = 0; i < nbTasks / 2; i++) {
+			tasks[i].chain = tasks[2 * i].chain;
+			tasks[i].other = tasks[2 * i + 1].chain;
+		}
+		runSortTasks(tasks, nbTasks / 2);
+
+		/* The odd one out waits for the next round */
+		if (nbTasks % 2 != 0) {
+			tasks[nbTasks / 2].chain = tasks[nbTasks - 1].chain;
+			tasks[nbTasks / 2].other = NULL;
+		}
+	}
+
+	llist->finger = NULL;
+	relinkChain(llist, tasks[0].chain);
+#ifdef LLIST_STATS
+	for (i = 0; i < nbThreads; i++) {
+		STAT_ADD(STATS_OF(llist), nbCmps, tasks[i].stats.nbCmps);
+		STAT_ADD(STATS_OF(llist), nbSwaps, tasks[i].stats.nbSwaps);
+	}
+#endif
+	allocatorFree(&(llist->allocator), tasks);
+
+	return 0;
+}
+
+
+int
+llist_parallelSort(LinkedList *llist, size_t nbThreads) {
+	int result;
+
+	TRACE_CALL(LLIST_OP_PARALLEL_SORT, llist, result = parallelSort(llist, nbThreads));
+	return result;
+}
+
+
+/* A Node of llist_sortByKey with its key next to it */
+struct SortKey {
+	unsigned long key;
+	struct Node *node;
+};
+
+
+/* Stable LSD radix sort of nbNodes keyed Nodes, using tmp (as large) as the
+ * other buffer of each pass. Passes over a digit all keys share are skipped.
+ * Returns the buffer (keyed or tmp) holding the sorted Nodes
+ */
+static struct SortKey *
+radixSort(struct SortKey *keyed, struct SortKey *tmp, size_t nbNodes) {
+	size_t counts[sizeof (unsigned long)][LLIST_RADIX_BUCKETS];
+	size_t digit, i;
+
+	memset(counts, 0, sizeof (counts));
+	for (i = 0; i < nbNodes; i++) {
+		unsigned long key = keyed[i].key;
+
+		for (digit = 0; digit < sizeof (unsigned long); digit++) {
+			counts[digit][key & (LLIST_RADIX_BUCKETS - 1)]++;
+			key >>= LLIST_RADIX_BITS;
+		}
+	}
+
+	for (digit = 0; digit < sizeof (unsigned long); digit++) {
+		size_t shift = digit * LLIST_RADIX_BITS;
+		size_t offset = 0;
+		struct SortKey *swap;
+
+		if (counts[digit][(keyed[0].key >> shift) & (LLIST_RADIX_BUCKETS - 1)] == nbNodes) {
+			continue;
+		}
+
+		/* Counts become the start of their bucket */
+		for (i = 0; i < LLIST_RADIX_BUCKETS; i++) {
+			size_t count = counts[digit][i];
+
+			counts[digit][i] = offset;
+			offset += count;
+		}
+		for (i = 0; i < nbNodes; i++) {
+			tmp[counts[digit][(keyed[i].key >> shift) & (LLIST_RADIX_BUCKETS - 1)]++] = keyed[i];
+		}
+
+		swap = keyed, keyed = tmp, tmp = swap;
+	}
+
+	return keyed;
+}
+
+
+/* Sifts nodes[root] down the max-heap nodes[0..nbNodes[ */
+static void
+siftDown(nodeCmpFunc f_cmpNode, LlistStats *stats, struct Node **nodes, size_t root, size_t nbNodes) {
+	struct Node *node = nodes[root];
+
+	(void)stats;
+	while (2 * root + 1 < nbNodes) {
+		size_t child = 2 * root + 1;
+
+		if (child + 1 < nbNodes && (STAT_ADD(stats, nbCmps, 1), f_cmpNode(nodes[child]->data, nodes[child + 1]->data) < 0)) {
+			child++;
+		}
+		STAT_ADD(stats, nbCmps, 1);
+		if (f_cmpNode(node->data, nodes[child]->data) >= 0) {
+			break;
+		}
+		nodes[root] = nodes[child];
+		root = child;
+	}
+	nodes[root] = node;
+}
+
+
+/* Introsort of nodes[0..nbNodes[: quicksort with a median of 3 pivot, turning
+ * into a heapsort past depthLimit partitions, small slices being left to the
+ * caller's final insertion sort */
+static void
+introSort(nodeCmpFunc f_cmpNode, LlistStats *stats, struct Node **nodes, size_t nbNodes, size_t depthLimit) {
+	while (nbNodes > LLIST_INSERTION_SORT_MAX) {
+		struct Node *tmp, *pivot;
+		size_t mid = nbNodes / 2;
+		size_t i, j;
+
+		if (depthLimit-- == 0) {
+			for (i = nbNodes / 2; i-- > 0; ) {
+				siftDown(f_cmpNode, stats, nodes, i, nbNodes);
+			}
+			for (i = nbNodes - 1; i > 0; i--) {
+				tmp = nodes[0], nodes[0] = nodes[i], nodes[i] = tmp;
+				siftDown(f_cmpNode, stats, nodes, 0, i);
+			}
+			return;
+		}
+
+		/* Sorts first, middle and last, the middle one becoming the pivot */
+		STAT_ADD(stats, nbCmps, 3);
+		if (f_cmpNode(nodes[mid]->data, nodes[0]->data) < 0) {
+			tmp = nodes[mid], nodes[mid] = nodes[0], nodes[0] = tmp;
+		}
+		if (f_cmpNode(nodes[nbNodes - 1]->data, nodes[mid]->data) < 0) {
+			tmp = nodes[mid], nodes[mid] = nodes[nbNodes - 1], nodes[nbNodes - 1] = tmp;
+			if (f_cmpNode(nodes[mid]->data, nodes[0]->data) < 0) {
+				tmp = nodes[mid], nodes[mid] = nodes[0], nodes[0] = tmp;
+			}
+		}
+		pivot = nodes[mid];
+
+		/* Hoare partition, first and last already being on the right side */
+		i = 0, j = nbNodes - 1;
+		for (;;) {
+			do {
+				i++;
+				STAT_ADD(stats, nbCmps, 1);
+			} while (f_cmpNode(nodes[i]->data, pivot->data) < 0);
+			do {
+				j--;
+				STAT_ADD(stats, nbCmps, 1);
+			} while (f_cmpNode(pivot->data, nodes[j]->data) < 0);
+			if (i >= j) {
+				break;
+			}
+			tmp = nodes[i], nodes[i] = nodes[j], nodes[j] = tmp;
+			STAT_ADD(stats, nbSwaps, 1);
+		}
+
+		/* Recurse on the smaller side, loop on the larger one */
+		if (j + 1 < nbNodes - j - 1) {
+			introSort(f_cmpNode, stats, nodes, j + 1, depthLimit);
+			nodes += j + 1;
+			nbNodes -= j + 1;
+		} else {
+			introSort(f_cmpNode, stats, nodes + j + 1, nbNodes - j - 1, depthLimit);
+			nbNodes = j + 1;
+		}
+	}
+}
+
+
+/* Sorts nodes[0..nbNodes[ with f_cmpNode (not stable) */
+static void
+sortNodeArray(nodeCmpFunc f_cmpNode, LlistStats *stats, struct Node **nodes, size_t nbNodes) {
+	size_t depthLimit = 0;
+	size_t i;
+
+	for (i = nbNodes; i > 1; i >>= 1) {
+		depthLimit += 2;
+	}
+	introSort(f_cmpNode, stats, nodes, nbNodes, depthLimit);
+
+	/* Every Node is now at most LLIST_INSERTION_SORT_MAX slots away from its place */
+	for (i = 1; i < nbNodes; i++) {
+		struct Node *node = nodes[i];
+		size_t j = i;
+
+		while (j > 0 && (STAT_ADD(stats, nbCmps, 1), f_cmpNode(node->data, nodes[j - 1]->data) < 0)) {
+			nodes[j] = nodes[j - 1];
+			j--;
+		}
+		nodes[j] = node;
+	}
+}
+
+
+/* Relinks llist in the order of the Nodes found at stride bytes from each
+ * other, starting at the Node pointer first */
+static void
+relinkArray(LinkedList *llist, struct Node **first, size_t stride, size_t nbNodes) {
+	struct Node *prev = NULL;
+	size_t i;
+
+	for (i = 0; i < nbNodes; i++) {
+		struct Node *node = *(struct Node **)((char *)first + i * stride);
+
+		node->prev = prev;
+		if (prev != NULL) {
+			prev->next = node;
+		}
+		prev = node;
+	}
+	prev->next = NULL;
+
+	llist->head = *first;
+	llist->tail = prev;
+}
+
+
+/*
+ * llist_sortByKey
+ *
+ * Sorts llist on the keys f_keyNode gives to the data, in increasing order,
+ * with ties keeping their order. The keys are computed once per Node and
+ * sorted along with the Nodes in a contiguous buffer by an LSD radix sort
+ * (no comparison at all), then the Nodes are relinked in a single pass.
+ *
+ * With a NULL f_keyNode, the Nodes are sorted in a buffer as well but with an
+ * introsort using llist->f_cmpNode, which isn't stable (llist_mergeSort is).
+ *
+ * Ordered lists are left as they are, like by llist_mergeSort
+ * Returns 0 on success, -1 if the buffer can't be allocated (llist is then
+ * left untouched)
+ */
+static int
+sortByKey(LinkedList *llist, nodeKeyFunc f_keyNode) {
+	struct Node *node;
+	size_t nbNodes, i;
+
+	assertList(llist);
+
+	if (llist->head == NULL || llist->skipList != NULL) {
+		return 0;
+	}
+	nbNodes = listSize(llist);
+
+	if (f_keyNode != NULL) {
+		struct SortKey *keyed, *sorted;
+
+		keyed = allocatorAlloc(&(llist->allocator), 2 * nbNodes * sizeof (*keyed));
+		if (keyed == NULL) {
+			return -1;
+		}
+		for (i = 0, node = llist->head; node != NULL; i++, node = node->next) {
+			keyed[i].key = f_keyNode(node->data);
+			keyed[i].node = node;
+		}
+
+		sorted = radixSort(keyed, keyed + nbNodes, nbNodes);
+		relinkArray(llist, &(sorted[0].node), sizeof (*sorted), nbNodes);
+		allocatorFree(&(llist->allocator), keyed);
+	} else {
+		struct Node **nodes = allocatorAlloc(&(llist->allocator), nbNodes * sizeof (*nodes));
+
+		if (nodes == NULL) {
+			return -1;
+		}
+		for (i = 0, node = llist->head; node != NULL; i++, node = node->next) {
+			nodes[i] = node;
+		}
+
+		sortNodeArray(llist->f_cmpNode, STATS_OF(llist), nodes, nbNodes);
+		relinkArray(llist, nodes, sizeof (*nodes), nbNodes);
+		allocatorFree(&(llist->allocator), nodes);
+	}
+
+	llist->finger = NULL;
+	return 0;
+}
+
+
+int
+llist_sortByKey(LinkedList *llist, nodeKeyFunc f_keyNode) {
+	int result;
+
+	TRACE_CALL(LLIST_OP_SORT_BY_KEY, llist, result = sortByKey(llist, f_keyNode));
+	return result;
+}
+
+
+int
+llist_bubbleSort(LinkedList *llist) {
+	struct Node *node, *prev;
+
+	assertList(llist);
+
+	/* Already sorted */
+	if (llist->head == NULL || llist->head->next == NULL || llist->skipList != NULL) {
+		return 0;
+	}
+
+	llist->finger = NULL;
+
+	for (prev = llist->head, node = llist->head->next; node != NULL; prev = node, node = node->next) {
+		struct Node *lastSorted = NULL;
+
+		/* while node is not at the head of the list and prev is "higher" than node */
+		while (prev != NULL && CMP_NODES(llist, prev->data, node->data) > 0) {
+			swapNodes(llist, prev, node);
+			STAT_ADD(STATS_OF(llist), nbSwaps, 1);
+			assert(prev->prev == node && node->next == prev);
+
+			/* prev is now after node */
+			if (lastSorted == NULL) {
+				lastSorted = prev;
+			}
+			/* update prev to be the new previous node (prev->prev before the swap) */
+			prev = node->prev;
+		}
+
+		if (lastSorted != NULL) {
+			node = lastSorted;
+			/* no need to update prev (since it will just get written to), but let's do it anyway */
+			prev = node->prev;
+		}
+	}
+
+	return 0;
+}
+
+
+/*
+ * llist_compact
+ *
+ * Moves every Node into a single new block, in list order, so that walking
+ * the list goes through contiguous memory. The block joins the list's pool
+ * and the old Nodes are released: when the pool is the list's alone, its old
+ * chunks are freed altogether.
+ *
+ * A list which wasn't pooled gets a pool of its own (see llist_newPooled):
+ * from then on it can't exchange Nodes (llist_concat, llist_splice,
+ * llist_mergeSorted, llist_setUnion...) with the lists it shared an allocator
+ * with, and its new Nodes are carved from chunks only released by
+ * llist_destroy. Lists which already shared a pool keep sharing it.
+ *
+ * The nbCursors cursors of cursors (which must be on llist or NULL) are moved
+ * to the new Nodes, any other cursor on llist becomes invalid. That is also
+ * why compaction is never triggered automatically.
+ *
+ * Returns 0 on success, -1 on allocation failure (llist is left untouched),
+ * -2 if llist has epochs enabled (readers could be on the old Nodes)
+ */
+int
+llist_compact(LinkedList *llist, struct Node ***cursors, size_t nbCursors) {
+	assertList(llist);
+	if (llist->epochs != NULL) {
+		return -2;
+	}
+
+	if (listSize(llist) == 0) {
+		return 0;
+	}
+	return moveNodes(llist, nodeSizeOf(llist->f_keyNode), cursors, nbCursors);
+}
+
+
+/* === Sorted functions === */
+/*
+ * llist_insertSorted
+ *
+ * Inserts data after the last Node which isn't after it, so llist (which must
+ * already be sorted by f_cmpNode) stays sorted and equal data stays in
+ * insertion order. O(log n) for ordered lists, O(n) otherwise
+ *
+ * Returns 0 on success, negative number on failure
+ */
+static int
+insertSortedData(LinkedList *llist, void *data) {
+	struct SkipTower *update[LLIST_SKIP_MAX_LEVEL];
+	struct Node *next, *newNode;
+	int ret;
+
+	assertList(llist);
+
+	newNode = new_node(llist, data);
+	if (newNode == NULL) {
+		return -1;
+	}
+
+	if (llist->skipList != NULL) {
+		next = skipSeek(llist, data, 1, update);
+	} else {
+		next = llist->head;
+		while (next != NULL && isBefore(llist, next->data, data, 1)) {
+			next = next->next;
+		}
+	}
+
+	if (next != NULL) {
+		ret = insertNode(llist, &next, newNode, LLIST_BEFORE);
+	} else {
+		ret = insertNode(llist, &(llist->tail), newNode, LLIST_AFTER);
+	}
+	if (ret != 0) {
+		destroyNode(llist, NULL, &newNode);
+		return -1;
+	}
+
+	if (llist->skipList != NULL) {
+		skipAddTower(llist, newNode, update);
+	}
+	return 0;
+}
+
+
+int
+llist_insertSorted(LinkedList *llist, void *data) {
+	int result;
+
+	TRACE_CALL(LLIST_OP_INSERT_SORTED, llist, result = insertSortedData(llist, data));
+	return result;
+}
+
+
+static int
+findBound(LinkedList *llist, struct Node **cursor, void *data, int b_after) {
+	struct Node *node;
+
+	assertList(llist);
+
+	if (cursor == NULL) {
+		return -2;
+	}
+
+	if (llist->skipList != NULL) {
+		node = skipSeek(llist, data, b_after, NULL);
+	} else {
+		node = llist->head;
+		while (node != NULL && isBefore(llist, node->data, data, b_after)) {
+			node = node->next;
+		}
+	}
+
+	if (node == NULL) {
+		return -1;
+	}
+
+	*cursor = node;
+	return 0;
+}
+
+
+/*
+ * llist_lowerBound
+ *
+ * Points cursor to the first Node which isn't before data in a list sorted by
+ * f_cmpNode. O(log n) for ordered lists, O(n) otherwise
+ *
+ * Returns 0 on success, -1 if every Node is before data (cursor is left
+ * untouched), -2 if cursor is invalid
+ */
+int
+llist_lowerBound(LinkedList *llist, struct Node **cursor, void *data) {
+	return findBound(llist, cursor, data, 0);
+}
+
+
+/* Same as llist_lowerBound, but for the first Node which is after data */
+int
+llist_upperBound(LinkedList *llist, struct Node **cursor, void *data) {
+	return findBound(llist, cursor, data, 1);
+}
+/* === END Sorted functions === */
+
+
+/* === Splice functions === */
+/* Detaches the chain first..last (first being before last) from llist */
+static void
+unlinkChain(LinkedList *llist, struct Node *first, struct Node *last) {
+	if (first->prev != NULL) {
+		first->prev->next = last->next;
+	} else {
+		llist->head = last->next;
+	}
+
+	if (last->next != NULL) {
+		last->next->prev = first->prev;
+	} else {
+		llist->tail = first->prev;
+	}
+
+	first->prev = last->next = NULL;
+}
+
+
+/* Links a detached chain first..last before or after insertPos
+ * (insertPos is NULL only if llist is empty) */
+static void
+linkChain(LinkedList *llist, struct Node *insertPos, struct Node *first, struct Node *last, LlistDirection dir) {
+	if (insertPos == NULL) {
+		assert(llist->head == NULL && llist->tail == NULL);
+		llist->head = first;
+		llist->tail = last;
+
+	} else if (dir == LLIST_BEFORE) {
+		first->prev = insertPos->prev;
+		last->next = insertPos;
+		if (insertPos->prev != NULL) {
+			insertPos->prev->next = first;
+		} else {
+			llist->head = first;
+		}
+		insertPos->prev = last;
+
+	} else {
+		first->prev = insertPos;
+		last->next = insertPos->next;
+		if (insertPos->next != NULL) {
+			insertPos->next->prev = last;
+		} else {
+			llist->tail = last;
+		}
+		insertPos->next = first;
+	}
+}
+
+
+/*
+ * llist_concat
+ *
+ * Moves every Node of src to the end of dst in O(1), src ends up empty
+ *
+ * Returns 0 on success, -1 if the lists don't allocate their Nodes the same
+ * way (different allocators or pools), -2 on invalid arguments
+ */
+int
+llist_concat(LinkedList *dst, LinkedList *src) {
+	if (dst == NULL || src == NULL || dst == src) {
+		return -2;
+	}
+	assertList(dst);
+	assertList(src);
+
+	if (!canShareNodes(dst, src)) {
+		return -1;
+	}
+
+	if (src->head == NULL) {
+		return 0;
+	}
+
+	linkChain(dst, dst->tail, src->head, src->tail, LLIST_AFTER);
+
+	if (dst->nbNodes == LLIST_SIZE_UNKNOWN || src->nbNodes == LLIST_SIZE_UNKNOWN) {
+		dst->nbNodes = LLIST_SIZE_UNKNOWN;
+	} else {
+		dst->nbNodes += src->nbNodes;
+		STAT_PEAK(dst);
+	}
+
+	src->head = src->tail = NULL;
+	src->nbNodes = 0;
+	src->finger = NULL;
+	return 0;
+}
+
+
+/*
+ * llist_mergeSorted
+ *
+ * Moves every Node of src into dst, both being sorted by dst->f_cmpNode, so
+ * that dst stays sorted. Nodes are relinked in O(n + m) without allocating
+ * anything and the merge is stable: on ties, Nodes of dst go first. src ends
+ * up empty
+ *
+ * Returns 0 on success, -1 if the lists can't exchange Nodes (see
+ * llist_concat), -2 on invalid arguments
+ */
+int
+llist_mergeSorted(LinkedList *dst, LinkedList *src) {
+	LinkedList *lists[2];
+
+	lists[0] = dst;
+	lists[1] = src;
+	return llist_mergeK(lists, 2);
+}
+
+
+/*
+ * llist_mergeK
+ *
+ * Same as llist_mergeSorted for the k lists of lists: all of their Nodes end
+ * up in lists[0], sorted by its f_cmpNode, in O(n log k). On ties, Nodes keep
+ * the order of their lists. The other lists (which must all be different)
+ * end up empty. Nothing moves unless every list can give its Nodes to
+ * lists[0]
+ *
+ * Returns 0 on success, -1 if a list can't exchange Nodes with lists[0] (see
+ * llist_concat), -2 on invalid arguments
+ */
+int
+llist_mergeK(LinkedList **lists, size_t k) {
+	LinkedList *dst;
+	struct Node *runs = NULL;
+	struct Node **p_lastRun = &runs;
+	size_t nbNodes = 0;
+	size_t i;
+
+	if (lists == NULL || k == 0 || lists[0] == NULL) {
+		return -2;
+	}
+	dst = lists[0];
+	assertList(dst);
+
+	for (i = 1; i < k; i++) {
+		if (lists[i] == NULL || lists[i] == dst) {
+			return -2;
+		}
+		assertList(lists[i]);
+		if (!canShareNodes(dst, lists[i])) {
+			return -1;
+		}
+	}
+
+	/* Every list is a run for mergeRuns, lists[0] first */
+	for (i = 0; i < k; i++) {
+		LinkedList *llist = lists[i];
+
+		if (llist->head == NULL) {
+			continue;
+		}
+		*p_lastRun = llist->head;
+		p_lastRun = &(llist->head->prev);
+
+		if (nbNodes != LLIST_SIZE_UNKNOWN && llist->nbNodes != LLIST_SIZE_UNKNOWN) {
+			nbNodes += llist->nbNodes;
+		} else {
+			nbNodes = LLIST_SIZE_UNKNOWN;
+		}
+		if (i > 0) {
+			llist->head = llist->tail = NULL;
+			llist->nbNodes = 0;
+			llist->finger = NULL;
+		}
+	}
+	*p_lastRun = NULL;
+
+	dst->finger = NULL;
+	relinkChain(dst, mergeRuns(dst->f_cmpNode, STATS_OF(dst), runs));
+	dst->nbNodes = nbNodes;
+	STAT_PEAK(dst);
+	return 0;
+}
+
+
+/*
+ * llist_splice
+ *
+ * Moves the Nodes from firstCursor to lastCursor (included, firstCursor must not
+ * be after lastCursor) out of src and links them before or after dstCursor in dst
+ * in O(1). dstCursor may point to NULL if dst is empty. src and dst can be the
+ * same list as long as dstCursor isn't within the moved Nodes
+ *
+ * All cursors stay valid. Unless all of src is moved, the sizes of both lists
+ * are recounted the next time they are needed
+ *
+ * Returns 0 on success, -1 if the lists don't allocate their Nodes the same
+ * way (different allocators or pools), -2 if a cursor is invalid, -3 if dir is
+ */
+int
+llist_splice(LinkedList *dst, struct Node **dstCursor, LinkedList *src,
+		struct Node **firstCursor, struct Node **lastCursor, LlistDirection dir) {
+	struct Node *first, *last;
+	size_t srcSize;
+
+	assertList(dst);
+	assertList(src);
+
+	if (!isUserPointerValid(firstCursor) || !isUserPointerValid(lastCursor) || dstCursor == NULL) {
+		return -2;
+	}
+	if (*dstCursor == NULL && dst->head != NULL) {
+		return -2;
+	}
+	if (dir != LLIST_BEFORE && dir != LLIST_AFTER) {
+		return -3;
+	}
+	if (!canShareNodes(dst, src)) {
+		return -1;
+	}
+
+	first = *firstCursor;
+	last = *lastCursor;
+	srcSize = src->nbNodes;
+
+	unlinkChain(src, first, last);
+	linkChain(dst, *dstCursor, first, last, dir);
+
+	dst->finger = src->finger = NULL;
+
+	if (dst != src) {
+		if (src->head == NULL) {
+			dst->nbNodes = (dst->nbNodes == 0) ? srcSize : LLIST_SIZE_UNKNOWN;
+			src->nbNodes = 0;
+		} else {
+			dst->nbNodes = src->nbNodes = LLIST_SIZE_UNKNOWN;
+		}
 	}
 
-	return llist;
+	return 0;
 }
 
 
-int
-llist_destroy(LinkedList **p_llist) {
+/* Empty list with the same callbacks and allocator as llist, sharing its pool
+ * (so that they can exchange Nodes), NULL on allocation failure */
+static LinkedList *
+newSibling(LinkedList *llist) {
+	LinkedList *newList = llist_newWithAllocator(llist->f_destroyNode, llist->f_cmpNode, &(llist->allocator));
+
+	if (newList == NULL) {
+		return NULL;
+	}
+	newList->f_keyNode = llist->f_keyNode;
+	newList->b_exactKey = llist->b_exactKey;
+
+	if (llist->pool != NULL) {
+		newList->pool = llist->pool;
+		newList->pool->refCount++;
+	}
+	return newList;
+}
+
+
+/*
+ * llist_splitAt
+ *
+ * Moves the Node cursor points to and every Node after it to a new list in O(1)
+ * The new list has the same callbacks and allocator as llist (and shares its pool)
+ *
+ * Returns the new list, NULL if cursor is invalid, llist is indexed, ordered
+ * or has epochs enabled, or on allocation failure
+ */
+LinkedList *
+llist_splitAt(LinkedList *llist, struct Node **cursor) {
+	LinkedList *newList;
 	struct Node *node;
-	int error = 0;
-	LinkedList *llist;
 
-	if (p_llist == NULL) {
-		return 0;
+	assertList(llist);
+
+	if (!isUserPointerValid(cursor) || llist->index != NULL || llist->skipList != NULL
+			|| llist->epochs != NULL) {
+		return NULL;
 	}
 
-	assertList(*p_llist);
+	newList = newSibling(llist);
+	if (newList == NULL) {
+		return NULL;
+	}
 
-	llist = *p_llist;
-	while (llist->head != NULL) {
+	node = *cursor;
+	newList->head = node;
+	newList->tail = llist->tail;
+
+	llist->tail = node->prev;
+	if (node->prev != NULL) {
+		node->prev->next = NULL;
+		node->prev = NULL;
+		newList->nbNodes = llist->nbNodes = LLIST_SIZE_UNKNOWN;
+	} else {
+		llist->head = NULL;
+		newList->nbNodes = llist->nbNodes;
+		llist->nbNodes = 0;
+	}
+
+	llist->finger = NULL;
+	return newList;
+}
+/* === END Splice functions === */
+
+
+
+/* === Set functions === */
+
+/* Only relinking (no index, express lanes or readers to keep up to date)
+ * lets set functions run in a single pass */
+static int
+canRelinkAll(LinkedList *llist) {
+	return llist->index == NULL && llist->skipList == NULL && llist->epochs == NULL;
+}
+
+
+/* Ends a set function's pass: llist becomes the nbNodes Nodes of chain */
+static void
+setChain(LinkedList *llist, struct Node *chain, size_t nbNodes) {
+	relinkChain(llist, chain);
+	llist->nbNodes = nbNodes;
+	llist->finger = NULL;
+	STAT_PEAK(llist);
+}
+
+
+/* Frees the Nodes of a chain linked through next, once the lists they were
+ * dropped from are consistent again (f_destroyNode may look at them)
+ * Returns 0, the last non-zero code returned by f_destroyNode otherwise
+ */
+static int
+dropChain(LinkedList *llist, nodeDestroyFunc f_destroyNode, struct Node *chain) {
+	int error = 0;
+
+	while (chain != NULL) {
+		struct Node *node = chain;
 		int destroyCode;
 
-		#if 0
-		assert(llist->nbNodes > 0);
-		#endif
-		node = popHeadNode(llist);
-		destroyCode = destroyNode(llist->f_destroyNode, &node);
+		chain = chain->next;
+		destroyCode = destroyNode(llist, f_destroyNode, &node);
 		if (destroyCode != 0) {
 			error = destroyCode;
 		}
-		#if 0
-		llist->nbNodes--;
-		#endif
 	}
 
-	free(*p_llist), *p_llist = llist = NULL;
 	return error;
 }
 
 
+/*
+ * llist_setUnion
+ *
+ * dst and src are sorted by dst->f_cmpNode. Moves the Nodes of src into dst
+ * (which stays sorted) except for those equal to a Node of dst, which are
+ * destroyed with src->f_destroyNode once dst is whole. A Node of dst
+ * cancels a single Node of src, so duplicates are kept as many times as the
+ * list having the most of them has them. src ends up empty. Runs in O(n + m)
+ *
+ * Returns 0 on success, -1 if the lists can't exchange Nodes (see
+ * llist_concat), -2 on invalid arguments, the last non-zero code returned by
+ * f_destroyNode otherwise
+ */
 int
-llistCursor_isTail(LinkedList *llist, struct Node **cursor) {
-	struct Node *node;
+llist_setUnion(LinkedList *dst, LinkedList *src) {
+	struct Node *chain = NULL, *dropped = NULL;
+	struct Node **p_link = &chain, **p_dropped = &dropped;
+	struct Node *node1, *node2;
+	size_t nbNodes = 0;
 
-	if (!isUserPointerValid(cursor)) {
+	if (dst == NULL || src == NULL || dst == src) {
+		return -2;
+	}
+	assertList(dst);
+	assertList(src);
+	if (!canShareNodes(dst, src)) {
 		return -1;
 	}
-	node = *cursor;
-	return !isTail(llist, node);
+
+	node1 = dst->head;
+	node2 = src->head;
+	while (node1 != NULL && node2 != NULL) {
+		int cmp = CMP_NODES(dst, node1->data, node2->data);
+
+		if (cmp <= 0) {
+			*p_link = node1;
+			node1 = node1->next;
+		} else {
+			*p_link = node2;
+			node2 = node2->next;
+		}
+		p_link = &((*p_link)->next);
+		nbNodes++;
+
+		if (cmp == 0) {
+			*p_dropped = node2;
+			p_dropped = &(node2->next);
+			node2 = node2->next;
+		}
+	}
+	for (*p_link = (node1 != NULL) ? node1 : node2; *p_link != NULL; p_link = &((*p_link)->next)) {
+		nbNodes++;
+	}
+	*p_dropped = NULL;
+
+	setChain(dst, chain, nbNodes);
+	src->head = src->tail = NULL;
+	src->nbNodes = 0;
+	src->finger = NULL;
+
+	return dropChain(dst, src->f_destroyNode, dropped);
 }
 
 
-int
-llistCursor_isHead(LinkedList *llist, struct Node **cursor) {
-	struct Node *node;
+/* Keeps the Nodes of dst which have (b_keepCommon) or don't have an equal
+ * Node in src, a Node of src matching a single Node of dst */
+static int
+filterSorted(LinkedList *dst, LinkedList *src, int b_keepCommon) {
+	struct Node *chain = NULL, *dropped = NULL;
+	struct Node **p_link = &chain, **p_dropped = &dropped;
+	struct Node *node1, *node2;
+	size_t nbNodes = 0;
 
-	if (!isUserPointerValid(cursor)) {
+	if (dst == NULL || src == NULL || dst == src) {
+		return -2;
+	}
+	assertList(dst);
+	assertList(src);
+	if (!canRelinkAll(dst)) {
 		return -1;
 	}
-	node = *cursor;
 
-	return !isHead(llist, node);
+	node1 = dst->head;
+	node2 = src->head;
+	while (node1 != NULL) {
+		int cmp = (node2 != NULL) ? CMP_NODES(dst, node1->data, node2->data) : -1;
+
+		if (cmp > 0) {
+			node2 = node2->next;
+			continue;
+		}
+
+		if ((cmp == 0) == b_keepCommon) {
+			*p_link = node1;
+			p_link = &(node1->next);
+			nbNodes++;
+		} else {
+			*p_dropped = node1;
+			p_dropped = &(node1->next);
+		}
+		node1 = node1->next;
+		if (cmp == 0) {
+			node2 = node2->next;
+		}
+	}
+	*p_link = NULL;
+	*p_dropped = NULL;
+
+	setChain(dst, chain, nbNodes);
+	return dropChain(dst, dst->f_destroyNode, dropped);
 }
 
 
-/* Returns 0 on success, negative number on failure */
+/*
+ * llist_setIntersect
+ *
+ * dst and src are sorted by dst->f_cmpNode. Destroys the Nodes of dst with no
+ * equal Node in src (each Node of src matching a single Node of dst), in
+ * O(n + m) and a single batch once dst is whole. src is left as it is
+ *
+ * Returns 0 on success, -1 if dst has an index, express lanes or epochs,
+ * -2 on invalid arguments, the last non-zero code returned by f_destroyNode
+ * otherwise
+ */
 int
-llist_insertHead(LinkedList *llist, void *data) {
-
-	return insertHead(llist, new_node(data));
+llist_setIntersect(LinkedList *dst, LinkedList *src) {
+	return filterSorted(dst, src, 1);
 }
 
 
-/* Returns 0 on success, negative number on failure */
+/*
+ * llist_setDifference
+ *
+ * Same as llist_setIntersect, but destroys the Nodes of dst which do have an
+ * equal Node in src instead
+ */
 int
-llist_insertTail(LinkedList *llist, void *data) {
-	return insertTail(llist, new_node(data));
+llist_setDifference(LinkedList *dst, LinkedList *src) {
+	return filterSorted(dst, src, 0);
 }
 
 
-/* Returns 0 on success, negative number on failure */
+/*
+ * llist_unique
+ *
+ * Keeps the first Node of every run of Nodes equal according to
+ * llist->f_cmpNode (so a sorted list ends up without duplicates) and
+ * destroys the others, in O(n) and a single batch once llist is whole
+ *
+ * Returns 0 on success, -1 if llist has an index, express lanes or epochs,
+ * the last non-zero code returned by f_destroyNode otherwise
+ */
 int
-llistCursor_insertData(LinkedList *llist, struct Node **cursor, void *data, LlistDirection dir) {
-	struct Node *newNode = new_node(data);
+llist_unique(LinkedList *llist) {
+	struct Node *dropped = NULL;
+	struct Node **p_dropped = &dropped;
+	struct Node *node;
+	size_t nbNodes;
 
-	if (!isUserPointerValid(cursor)) {
-		return -2;
+	assertList(llist);
+	if (!canRelinkAll(llist)) {
+		return -1;
 	}
+	if (llist->head == NULL) {
+		return 0;
+	}
+
+	for (node = llist->head, nbNodes = 1; node->next != NULL; ) {
+		struct Node *next = node->next;
+
+		if (CMP_NODES(llist, node->data, next->data) == 0) {
+			node->next = next->next;
+			*p_dropped = next;
+			p_dropped = &(next->next);
+		} else {
+			node = next;
+			nbNodes++;
+		}
+	}
+	*p_dropped = NULL;
 
-	return insertNode(llist, cursor, newNode, dir);
+	setChain(llist, llist->head, nbNodes);
+	return dropChain(llist, llist->f_destroyNode, dropped);
 }
 
 
-/* Caller is responsible of freeing the data returned */
-void *
-llist_popNode(LinkedList *llist, struct Node **cursor) {
-	void *data;
-	struct Node *node;
 
-	if (!isUserPointerValid(cursor)) {
-		return NULL;
+/* Open addressing slot of llist_uniqueUnordered and llist_groupBy: the
+ * first Node of its key, and for groups their last Node, size and the slot
+ * of the next group in order of appearance */
+struct HashSlot {
+	struct Node *first;
+	struct Node *last;
+	size_t nbNodes;
+	struct HashSlot *nextGroup;
+};
+
+
+/* Zeroed table with room for nbNodes keys at a load factor of at most 1/2,
+ * NULL on allocation failure */
+static struct HashSlot *
+hashSlotsNew(LinkedList *llist, size_t nbNodes, size_t *p_nbSlots) {
+	struct HashSlot *slots;
+	size_t nbSlots = LLIST_INDEX_MIN_BUCKETS;
+
+	while (nbSlots < 2 * nbNodes) {
+		nbSlots *= 2;
+	}
+	slots = allocatorAlloc(&(llist->allocator), nbSlots * sizeof (*slots));
+	if (slots != NULL) {
+		memset(slots, 0, nbSlots * sizeof (*slots));
 	}
-	node = *cursor;
 
-	assert(node == popNode(llist, node));
+	*p_nbSlots = nbSlots;
+	return slots;
+}
 
-	data = node->data;
-	destroyNode(NULL, cursor);
-	return data;
+
+/* Slot of the key of node: the one holding a Node equal to it, else the
+ * empty slot where it goes (linear probing, nbSlots is a power of 2) */
+static struct HashSlot *
+hashSlotOf(LinkedList *llist, struct HashSlot *slots, size_t nbSlots, nodeHashFunc f_hashNode, struct Node *node) {
+	size_t i = f_hashNode(node->data) & (nbSlots - 1);
+
+	while (slots[i].first != NULL && !nodeMatches(llist, slots[i].first, node->data, nodeKey(llist, node))) {
+		i = (i + 1) & (nbSlots - 1);
+	}
+	return &slots[i];
 }
 
 
+/*
+ * llist_uniqueUnordered
+ *
+ * Keeps the first Node of every set of Nodes equal according to
+ * llist->f_cmpNode, wherever they are, and destroys the others in a single
+ * batch once llist is whole. Runs in expected O(n) with a temporary hash
+ * table: f_hashNode must give equal hashes to equal data (like the one of
+ * llist_enableIndex)
+ *
+ * Returns 0 on success, -1 if llist has an index, express lanes or epochs,
+ * -2 if the table can't be allocated (llist is then left untouched), the last
+ * non-zero code returned by f_destroyNode otherwise
+ */
 int
-llist_removeNode(LinkedList *llist, struct Node **cursor) {
+llist_uniqueUnordered(LinkedList *llist, nodeHashFunc f_hashNode) {
+	struct Node *chain = NULL, *dropped = NULL;
+	struct Node **p_link = &chain, **p_dropped = &dropped;
+	struct HashSlot *slots;
 	struct Node *node;
+	size_t nbSlots, nbNodes = 0;
 
 	assertList(llist);
-	if (!isUserPointerValid(cursor)) {
+	assert(f_hashNode != NULL);
+	if (!canRelinkAll(llist)) {
 		return -1;
 	}
+	if (llist->head == NULL) {
+		return 0;
+	}
 
-	node = popNode(llist, *cursor);
-	assert(node == *cursor);
+	slots = hashSlotsNew(llist, listSize(llist), &nbSlots);
+	if (slots == NULL) {
+		return -2;
+	}
+
+	for (node = llist->head; node != NULL; node = node->next) {
+		struct HashSlot *slot = hashSlotOf(llist, slots, nbSlots, f_hashNode, node);
 
-	return destroyNode(llist->f_destroyNode, cursor);
+		if (slot->first == NULL) {
+			slot->first = node;
+			*p_link = node;
+			p_link = &(node->next);
+			nbNodes++;
+		} else {
+			*p_dropped = node;
+			p_dropped = &(node->next);
+		}
+	}
+	*p_link = NULL;
+	*p_dropped = NULL;
+	allocatorFree(&(llist->allocator), slots);
+
+	setChain(llist, chain, nbNodes);
+	return dropChain(llist, llist->f_destroyNode, dropped);
 }
 
 
-/* Returns NULL in case of error
- * Caller is responsible of freeing data
+/*
+ * llist_groupBy
+ *
+ * Moves the Nodes of llist into new lists, one per set of Nodes equal
+ * according to llist->f_cmpNode, by relinking them in expected O(n) (see
+ * llist_uniqueUnordered for f_hashNode). Groups come in the order their first
+ * Node appeared in and keep the order of their Nodes. They have the same
+ * callbacks and allocator as llist (and share its pool). llist ends up empty.
+ *
+ * On success, *p_groups is an array of *p_nbGroups lists allocated with
+ * malloc(), the caller destroys the lists then frees it (it is NULL when
+ * llist was empty)
+ *
+ * Returns 0 on success, -1 if llist has an index, express lanes or epochs,
+ * -2 on allocation failure (llist is then left untouched)
  */
-void *
-llist_popHead(LinkedList *llist) {
+int
+llist_groupBy(LinkedList *llist, nodeHashFunc f_hashNode, LinkedList ***p_groups, size_t *p_nbGroups) {
+	struct HashSlot *slots, *slot;
+	struct HashSlot *firstGroup = NULL;
+	struct HashSlot **p_lastGroup = &firstGroup;
+	LinkedList **groups;
+	struct Node *node;
+	size_t nbSlots, nbGroups = 0, i;
+
 	assertList(llist);
+	assert(f_hashNode != NULL && p_groups != NULL && p_nbGroups != NULL);
+	*p_groups = NULL;
+	*p_nbGroups = 0;
+	if (!canRelinkAll(llist)) {
+		return -1;
+	}
+	if (llist->head == NULL) {
+		return 0;
+	}
 
-	if (llist == NULL) {
-		return NULL;
+	slots = hashSlotsNew(llist, listSize(llist), &nbSlots);
+	if (slots == NULL) {
+		return -2;
+	}
+
+	/* Groups are chained backwards through prev, next still walks llist */
+	for (node = llist->head; node != NULL; node = node->next) {
+		slot = hashSlotOf(llist, slots, nbSlots, f_hashNode, node);
+		if (slot->first == NULL) {
+			slot->first = node;
+			*p_lastGroup = slot;
+			p_lastGroup = &(slot->nextGroup);
+			nbGroups++;
+		}
+		node->prev = slot->last;
+		slot->last = node;
+		slot->nbNodes++;
 	}
-	return popHeadNode(llist);
-}
 
+	groups = malloc(nbGroups * sizeof (*groups));
+	for (i = 0; groups != NULL && i < nbGroups; i++) {
+		groups[i] = newSibling(llist);
+		if (groups[i] == NULL) {
+			while (i-- > 0) {
+				llist_destroy(&groups[i]);
+			}
+			free(groups), groups = NULL;
+		}
+	}
+	if (groups == NULL) {
+		allocatorFree(&(llist->allocator), slots);
+		relinkChain(llist, llist->head);
+		return -2;
+	}
 
-/* Returns NULL in case of error
- * Caller is responsible of freeing data
- */
-void *
-llist_popTail(LinkedList *llist) {
-	assertList(llist);
+	for (i = 0, slot = firstGroup; slot != NULL; i++, slot = slot->nextGroup) {
+		struct Node *next = NULL;
 
-	if (llist == NULL) {
-		return NULL;
+		for (node = slot->last; node != NULL; node = node->prev) {
+			node->next = next;
+			next = node;
+		}
+		relinkChain(groups[i], slot->first);
+		groups[i]->nbNodes = slot->nbNodes;
+		STAT_PEAK(groups[i]);
 	}
-	return popTailNode(llist);
+	assert(i == nbGroups);
+	allocatorFree(&(llist->allocator), slots);
+
+	llist->head = llist->tail = NULL;
+	llist->nbNodes = 0;
+	llist->finger = NULL;
+
+	*p_groups = groups;
+	*p_nbGroups = nbGroups;
+	return 0;
 }
 
+/* === END Set functions === */
 
-/*
- * llist_countMatch
- *
- * llist: LinkedList to search into
- * data: data to match such that llist->f_cmpNode(nodeData, data) == 0
+
+/* === Bulk functions === */
+
+/* A traversal of the whole list cut into chunks of chunkNodes consecutive
+ * Nodes (the last one can be shorter) for llistPool_run. Every operation
+ * only uses its own fields
  */
-size_t
-llist_countMatch(LinkedList *llist, void *data) {
+struct BulkJob {
+	struct Node **chunks;
+	struct Node *singleChunk;
+	size_t nbChunks;
+	size_t chunkNodes;
+	void *context;
+
+	/* llist_forEach, stopCode is the first non-zero code returned */
+	nodeVisitFunc f_visit;
+	int stopCode;
+
+	/* llist_mapInPlace, keys get recomputed with f_keyNode */
+	nodeMapFunc f_map;
+	nodeKeyFunc f_keyNode;
+
+	/* llist_reduce, partials holds one accumulator per chunk, accStride apart */
+	nodeReduceFunc f_reduce;
+	char *partials;
+	size_t accStride;
+
+	/* llist_parallelCountMatch, probeKey and b_exactKey as with nodeMatches */
+	nodeCmpFunc f_cmpNode;
+	void *probe;
+	unsigned long probeKey;
+	int b_exactKey;
+	size_t *counts;
+};
+
+
+/* Returns 0 on success, -1 if the chunks can't be allocated */
+static int
+initBulkJob(LinkedList *llist, struct BulkJob *job, size_t nbThreads, void *context) {
+	size_t nbNodes = listSize(llist);
 	struct Node *node;
-	size_t count = 0;
+	size_t i;
 
-	for (node = llist->head; node != NULL; node = node->next) {
-		if (0 == llist->f_cmpNode(data, node->data)) {
+	memset(job, 0, sizeof (*job));
+	job->context = context;
+
+	job->nbChunks = (nbThreads > 1) ? nbThreads * LLIST_CHUNKS_PER_THREAD : 1;
+	if (job->nbChunks > nbNodes) {
+		job->nbChunks = (nbNodes > 0) ? nbNodes : 1;
+	}
+	job->chunkNodes = (nbNodes + job->nbChunks - 1) / job->nbChunks;
+	if (job->chunkNodes > 0) {
+		job->nbChunks = (nbNodes + job->chunkNodes - 1) / job->chunkNodes;
+	}
+
+	if (job->nbChunks == 1) {
+		job->chunks = &(job->singleChunk);
+	} else {
+		job->chunks = allocatorAlloc(&(llist->allocator), job->nbChunks * sizeof (*job->chunks));
+		if (job->chunks == NULL) {
+			return -1;
+		}
+	}
+
+	node = llist->head;
+	for (i = 0; node != NULL; i++, node = node->next) {
+		if (i % job->chunkNodes == 0) {
+			job->chunks[i / job->chunkNodes] = node;
+		}
+	}
+	if (nbNodes == 0) {
+		job->chunks[0] = NULL;
+	}
+
+	return 0;
+}
+
+
+static void
+destroyBulkJob(LinkedList *llist, struct BulkJob *job) {
+	if (job->chunks != &(job->singleChunk)) {
+		allocatorFree(&(llist->allocator), job->chunks);
+	}
+}
+
+
+static void
+runVisitChunk(void *arg, size_t chunk) {
+	struct BulkJob *job = arg;
+	struct Node *node = job->chunks[chunk];
+	size_t i;
+
+	for (i = 0; i < job->chunkNodes && node != NULL; i++, node = node->next) {
+		int code;
+
+		if (ATOMIC_LOAD_RELAXED(&(job->stopCode)) != 0) {
+			return;
+		}
+
+		code = job->f_visit(node->data, job->context);
+		if (code != 0) {
+			int noCode = 0;
+
+			ATOMIC_CAS(&(job->stopCode), &noCode, code);
+			return;
+		}
+	}
+}
+
+
+static void
+runMapChunk(void *arg, size_t chunk) {
+	struct BulkJob *job = arg;
+	struct Node *node = job->chunks[chunk];
+	size_t i;
+
+	for (i = 0; i < job->chunkNodes && node != NULL; i++, node = node->next) {
+		node->data = job->f_map(node->data, job->context);
+		if (job->f_keyNode != NULL) {
+			NODE_KEY(node) = job->f_keyNode(node->data);
+		}
+	}
+}
+
+
+static void
+runReduceChunk(void *arg, size_t chunk) {
+	struct BulkJob *job = arg;
+	struct Node *node = job->chunks[chunk];
+	void *acc = job->partials + chunk * job->accStride;
+	size_t i;
+
+	for (i = 0; i < job->chunkNodes && node != NULL; i++, node = node->next) {
+		job->f_reduce(acc, node->data, job->context);
+	}
+}
+
+
+static void
+runCountChunk(void *arg, size_t chunk) {
+	struct BulkJob *job = arg;
+	struct Node *node = job->chunks[chunk];
+	size_t i, count = 0;
+
+	for (i = 0; i < job->chunkNodes && node != NULL; i++, node = node->next) {
+		if (job->f_keyNode != NULL) {
+			if (NODE_KEY(node) != job->probeKey) {
+				continue;
+			}
+			if (job->b_exactKey) {
+				count++;
+				continue;
+			}
+		}
+		if (0 == job->f_cmpNode(job->probe, node->data)) {
 			count++;
 		}
 	}
-
-	return count;
+	job->counts[chunk] = count;
 }
 
 
-int
-llistCursor_findNext(LinkedList *llist, struct Node **cursor, void *data) {
-	if (llistCursor_getNext(llist, cursor) != 0) {
-		return -4;
+/* Moves every entry to the bucket of its Node's current data */
+static void
+indexRehash(struct NodeIndex *index) {
+	struct IndexEntry *entries = NULL;
+	size_t i;
+
+	for (i = 0; i < index->nbBuckets; i++) {
+		while (index->buckets[i] != NULL) {
+			struct IndexEntry *entry = index->buckets[i];
+
+			index->buckets[i] = entry->next;
+			entry->next = entries;
+			entries = entry;
+		}
 	}
-	return llistCursor_find(llist, cursor, data, LLIST_AFTER);
-}
 
+	while (entries != NULL) {
+		struct IndexEntry *entry = entries;
+		struct IndexEntry **p_bucket;
 
-int
-llistCursor_findPrev(LinkedList *llist, struct Node **cursor, void *data) {
-	if (llistCursor_getPrev(llist, cursor) != 0) {
-		return -4;
+		entries = entry->next;
+		entry->hash = index->f_hashNode(entry->node->data);
+		p_bucket = indexBucket(index, entry->hash);
+		entry->next = *p_bucket;
+		*p_bucket = entry;
 	}
-	return llistCursor_find(llist, cursor, data, LLIST_BEFORE);
 }
 
 
 /*
- * llistCursor_find
+ * llist_forEach
  *
- * llist: LinkedList to search into
- * searchBase: the Node to start the search at
- * data: data to match such that llist->f_cmpNode(data, nodeData) == 0
- * searchDir: the direction to search in
+ * Calls f_visit(data, context) on every Node's data, spread over nbThreads
+ * threads of the library's pool (0 or 1 runs on the calling thread only, in
+ * list order). The callbacks run at the same time, so f_visit must be
+ * thread-safe, and they must not modify the list. Bulk calls made from a
+ * callback (of any bulk function) run on the callback's thread only.
+ *
+ * f_visit returns 0 to keep going: any other code stops the traversal as soon
+ * as every thread notices, and the first such code is returned. Nodes after
+ * the one which stopped it may have been visited already by other threads.
+ *
+ * Returns 0 once every Node was visited, -1 on allocation failure
  */
 int
-llistCursor_find(LinkedList *llist, struct Node **cursor, void *data, LlistDirection searchDir) {
-	struct Node *node;
+llist_forEach(LinkedList *llist, size_t nbThreads, nodeVisitFunc f_visit, void *context) {
+	struct BulkJob job;
 
 	assertList(llist);
-	if (!isUserPointerValid(cursor)) {
-		return -2;
+	if (f_visit == NULL || initBulkJob(llist, &job, nbThreads, context) != 0) {
+		return -1;
 	}
 
-	for (node = *cursor; node != NULL; ) {
-		if (0 == llist->f_cmpNode(data, node->data)) {
-			*cursor = node;
-			return 0;
-		}
-
-		switch (searchDir) {
-		case LLIST_BEFORE:
-
-			node = node->prev;
-			break;
-		case LLIST_AFTER:
-
-			node = node->next;
-			break;
-		default:
-			return -3;
-		}
-	}
+	job.f_visit = f_visit;
+	llistPool_run(nbThreads, job.nbChunks, runVisitChunk, &job);
 
-	assert(node == NULL);
-	return -1;
+	destroyBulkJob(llist, &job);
+	return job.stopCode;
 }
 
 
-static void
-swapNodes(LinkedList *llist, struct Node *node1, struct Node *node2) {
-	int b_neighbours;
-	struct Node
-			*prev1,
-			*next1,
-			*prev2,
-			*next2;
-
-	assert(node1 != NULL && node2 != NULL);
+/*
+ * llist_mapInPlace
+ *
+ * Replaces every Node's data by f_map(data, context), spread over nbThreads
+ * threads like llist_forEach. The index, if any, is rebuilt afterwards.
+ *
+ * Returns 0 on success, -1 on allocation failure, -2 for ordered lists
+ * (whose order the new data could break)
+ */
+int
+llist_mapInPlace(LinkedList *llist, size_t nbThreads, nodeMapFunc f_map, void *context) {
+	struct BulkJob job;
 
-	/* If both nodes are next to each other, make sure
-	 * node1 refers to the first one */
-	if (node1->prev == node2) {
-		struct Node *tmp = node1;
-		node1 = node2;
-		node2 = tmp;
+	assertList(llist);
+	if (llist->skipList != NULL) {
+		return -2;
+	}
+	if (f_map == NULL || initBulkJob(llist, &job, nbThreads, context) != 0) {
+		return -1;
 	}
 
-	/* Sync test */
-	assert( ! ((node1->next == node2) ^ (node2->prev == node1)));
+	job.f_map = f_map;
+	job.f_keyNode = llist->f_keyNode;
+	llistPool_run(nbThreads, job.nbChunks, runMapChunk, &job);
+	destroyBulkJob(llist, &job);
 
+	if (llist->index != NULL) {
+		indexRehash(llist->index);
+	}
+	return 0;
+}
 
-	prev1 = node1->prev;
-	next1 = node1->next;
-	next2 = node2->next;
-	prev2 = node2->prev;
 
-	b_neighbours = (node1->next == node2);
+/*
+ * llist_reduce
+ *
+ * acc: accumulator of accSize bytes, holding the identity of f_combine (e.g. 0
+ *      for a sum) on entry and the result on return
+ *
+ * Every chunk of the list (see llist_forEach) gets its own copy of *acc, which
+ * f_reduce(chunkAcc, data, context) folds the chunk's Nodes into, in list
+ * order. Chunks are then folded into acc, in list order too, with
+ * f_combine(acc, chunkAcc, context), so f_combine only needs to be associative.
+ *
+ * Returns 0 on success, -1 on allocation failure
+ */
+int
+llist_reduce(LinkedList *llist, size_t nbThreads, nodeReduceFunc f_reduce, nodeCombineFunc f_combine,
+		void *acc, size_t accSize, void *context) {
+	struct BulkJob job;
+	size_t i;
 
-	if (prev1 != NULL) {
-		prev1->next = node2;
-	}
-	if (next2 != NULL) {
-		next2->prev = node1;
+	assertList(llist);
+	if (f_reduce == NULL || f_combine == NULL || acc == NULL
+			|| initBulkJob(llist, &job, nbThreads, context) != 0) {
+		return -1;
 	}
 
-	if (b_neighbours) {
-		node1->prev = node2;
-		node2->next = node1;
+	/* Chunks on different threads shouldn't share a cache line */
+	job.accStride = (accSize + LLIST_CACHE_LINE - 1) / LLIST_CACHE_LINE * LLIST_CACHE_LINE;
+	job.partials = allocatorAlloc(&(llist->allocator), job.nbChunks * job.accStride);
+	if (job.partials == NULL) {
+		destroyBulkJob(llist, &job);
+		return -1;
+	}
+	for (i = 0; i < job.nbChunks; i++) {
+		memcpy(job.partials + i * job.accStride, acc, accSize);
+	}
 
-	} else {
-		if (next1 != NULL) {
-			next1->prev = node2;
-		}
-		if (prev2 != NULL) {
-			prev2->next = node1;
-		}
+	job.f_reduce = f_reduce;
+	llistPool_run(nbThreads, job.nbChunks, runReduceChunk, &job);
 
-		node1->prev = prev2;
-		node2->next = next1;
+	for (i = 0; i < job.nbChunks; i++) {
+		f_combine(acc, job.partials + i * job.accStride, context);
 	}
 
-	node2->prev = prev1;
-	node1->next = next2;
+	allocatorFree(&(llist->allocator), job.partials);
+	destroyBulkJob(llist, &job);
+	return 0;
+}
 
 
-	if (llist->head == node1) {
-		llist->head = node2;
-	} else if (llist->head == node2) {
-		llist->head = node1;
+/* Same as llist_countMatch, over nbThreads threads (see llist_forEach)
+ * The index, if any, is faster and gets used instead
+ */
+size_t
+llist_parallelCountMatch(LinkedList *llist, void *data, size_t nbThreads) {
+	struct BulkJob job;
+	size_t i, count = 0;
+
+	assertList(llist);
+	if (llist->index != NULL || nbThreads <= 1) {
+		return llist_countMatch(llist, data);
+	}
+	if (initBulkJob(llist, &job, nbThreads, NULL) != 0) {
+		return llist_countMatch(llist, data);
 	}
 
-	if (llist->tail == node1) {
-		llist->tail = node2;
-	} else if (llist->tail == node2) {
-		llist->tail = node1;
+	job.counts = allocatorAlloc(&(llist->allocator), job.nbChunks * sizeof (*job.counts));
+	if (job.counts == NULL) {
+		destroyBulkJob(llist, &job);
+		return llist_countMatch(llist, data);
 	}
-}
 
+	job.f_cmpNode = llist->f_cmpNode;
+	job.probe = data;
+	job.f_keyNode = llist->f_keyNode;
+	job.probeKey = probeKey(llist, data);
+	job.b_exactKey = llist->b_exactKey;
+	llistPool_run(nbThreads, job.nbChunks, runCountChunk, &job);
 
-int
-llist_bubbleSort(LinkedList *llist) {
-	struct Node *node, *prev;
+	for (i = 0; i < job.nbChunks; i++) {
+		count += job.counts[i];
+	}
 
-	assertList(llist);
+	allocatorFree(&(llist->allocator), job.counts);
+	destroyBulkJob(llist, &job);
+	return count;
+}
 
-	/* Already sorted */
-	if (llist->head == NULL || llist->head->next == NULL) {
-		return 0;
-	}
 
-	for (prev = llist->head, node = llist->head->next; node != NULL; prev = node, node = node->next) {
-		struct Node *lastSorted = NULL;
+/* Joins the threads of the library's pool, new ones get created when needed
+ * (mostly useful before exiting, or to leak checkers) */
+void
+llist_stopWorkers(void) {
+	llistPool_shutdown();
+}
 
-		/* while node is not at the head of the list and prev is "higher" than node */
-		while (prev != NULL && llist->f_cmpNode(prev->data, node->data) > 0) {
-			swapNodes(llist, prev, node);
-			assert(prev->prev == node && node->next == prev);
+/* === END Bulk functions === */
 
-			/* prev is now after node */
-			if (lastSorted == NULL) {
-				lastSorted = prev;
-			}
-			/* update prev to be the new previous node (prev->prev before the swap) */
-			prev = node->prev;
-		}
 
-		if (lastSorted != NULL) {
-			node = lastSorted;
-			/* no need to update prev (since it will just get written to), but let's do it anyway */
-			prev = node->prev;
-		}
-	}
+/* O(1), except right after llist_splice or llist_splitAt where the Nodes
+ * are counted once */
+size_t
+llist_size(LinkedList *llist) {
+	assertList(llist);
 
-	return 0;
+	return listSize(llist);
 }
 
 
@@ -635,6 +4088,49 @@ llist_getTailData(LinkedList *llist) {
 }
 
 
+
+/* === Stats functions === */
+
+/*
+ * llist_getStats
+ *
+ * Copies the operation counters of llist into *stats: f_cmpNode calls, Nodes
+ * (or index entries) visited by llistCursor_find and llist_countMatch, Node
+ * allocations and frees, Nodes swapped by sorting and the largest size the
+ * list reached (while its size was known)
+ *
+ * Returns 0, or -2 when the library wasn't built with LLIST_STATS (*stats is
+ * then all zeros)
+ */
+int
+llist_getStats(LinkedList *llist, LlistStats *stats) {
+	assertList(llist);
+	assert(stats != NULL);
+
+#ifdef LLIST_STATS
+	*stats = llist->stats;
+	return 0;
+#else
+	memset(stats, 0, sizeof (*stats));
+	return -2;
+#endif
+}
+
+
+/* Zeroes the counters, peakSize restarts from the current size */
+void
+llist_resetStats(LinkedList *llist) {
+	assertList(llist);
+
+#ifdef LLIST_STATS
+	memset(&(llist->stats), 0, sizeof (llist->stats));
+	STAT_PEAK(llist);
+#endif
+}
+
+/* === END Stats functions === */
+
+
 /* === Cursor functions === */
 /* We can't return Nodes to the user, that would be ABI dependant.
  * We can't return pointers to Nodes, because we can't set the user pointer to NULL when we free Nodes
@@ -688,22 +4184,65 @@ llist_getTailData(LinkedList *llist) {
  */
 struct Node **
 llistCursor_new(void) {
-	struct Node **cursor = malloc(sizeof (*cursor));
+	return llistCursor_newWithAllocator(NULL);
+}
+
+
+/* The allocator is copied, NULL means malloc/free */
+struct Node **
+llistCursor_newWithAllocator(const LlistAllocator *allocator) {
+	struct CursorBlock *block;
+
+	if (allocator == NULL) {
+		allocator = &defaultAllocator;
+	} else if (allocator->f_alloc == NULL) {
+		return NULL;
+	}
+
+	block = allocatorAlloc(allocator, sizeof (*block));
+	if (block == NULL) {
+		return NULL;
+	}
+
+	block->allocator = *allocator;
+	block->node = NULL;
+	return &(block->node);
+}
+
+
+static struct CursorBlock *
+cursorBlock(struct Node **cursor) {
+	return (struct CursorBlock *)((char *)cursor - offsetof(struct CursorBlock, node));
+}
+
 
-	if (cursor != NULL) {
-		*cursor = NULL;
+/* The copy points to the same Node and uses the same allocator */
+struct Node **
+llistCursor_copy(struct Node **cursor) {
+	struct Node **copy;
+
+	if (cursor == NULL) {
+		return NULL;
 	}
-	return cursor;
+
+	copy = llistCursor_newWithAllocator(&(cursorBlock(cursor)->allocator));
+	if (copy != NULL) {
+		*copy = *cursor;
+	}
+	return copy;
 }
 
 
 int
 llistCursor_destroy(struct Node ***p_cursor) {
 	if (p_cursor != NULL) {
+		struct CursorBlock *block;
+
 		if (*p_cursor == NULL) {
 			return 0;
 		}
-		free(*p_cursor), *p_cursor = NULL;
+		block = cursorBlock(*p_cursor);
+		allocatorFree(&(block->allocator), block), *p_cursor = NULL;
 		return 0;
 	}
 	return -1;
@@ -721,7 +4260,27 @@ llistCursor_setData(LinkedList *llist, struct Node **cursor, void *newData) {
 		return -1;
 	}
 
+	/* Ordered lists can only swap data for equal data */
+	if (llist->skipList != NULL && 0 != CMP_NODES(llist, (*cursor)->data, newData)) {
+		return -2;
+	}
+
+	/* Move the Node's entry to the bucket of its new data */
+	if (llist->index != NULL) {
+		struct NodeIndex *index = llist->index;
+		struct IndexEntry *entry = indexDetach(index, *cursor, index->f_hashNode((*cursor)->data));
+		struct IndexEntry **p_bucket;
+
+		entry->hash = index->f_hashNode(newData);
+		p_bucket = indexBucket(index, entry->hash);
+		entry->next = *p_bucket;
+		*p_bucket = entry;
+	}
+
 	(*cursor)->data = newData;
+	if (llist->f_keyNode != NULL) {
+		NODE_KEY(*cursor) = llist->f_keyNode(newData);
+	}
 	return 0;
 }
 
@@ -732,7 +4291,7 @@ void *
 llistCursor_getData(LinkedList *llist, struct Node **cursor) {
 	struct Node *node;
 
-	assertList(llist);
+	assert(llist != NULL);
 
 	if (!isUserPointerValid(cursor)) {
 		return NULL;
@@ -743,59 +4302,132 @@ llistCursor_getData(LinkedList *llist, struct Node **cursor) {
 }
 
 
+/* Safe for epoch readers (see llist_enableEpochs), hence no assertList */
 int
 llistCursor_getHead(LinkedList *llist, struct Node **cursor) {
+	assert(llist != NULL);
+
+	if (cursor == NULL) {
+		return -1;
+	}
+
+	*cursor = ATOMIC_LOAD_ACQUIRE(&(llist->head));
+	return 0;
+}
+
+
+/*
+ * llistCursor_seek
+ *
+ * Points cursor to the Node at index (0 is the head). The walk starts from
+ * whichever of the head, the tail or the last Node seeked to is the closest,
+ * so sequential or nearby accesses are cheap
+ *
+ * Returns 0 on success, -1 if index is out of range, -2 if cursor is invalid
+ */
+static int
+seekIndex(LinkedList *llist, struct Node **cursor, size_t index) {
+	struct Node *node;
+	size_t nodeIndex, distance;
+
 	assertList(llist);
 
 	if (cursor == NULL) {
+		return -2;
+	}
+	if (index >= listSize(llist)) {
 		return -1;
 	}
 
-	*cursor = llist->head;
+	node = llist->head;
+	nodeIndex = 0;
+	distance = index;
+
+	if (llist->nbNodes - 1 - index < distance) {
+		node = llist->tail;
+		nodeIndex = llist->nbNodes - 1;
+		distance = nodeIndex - index;
+	}
+
+	if (llist->finger != NULL) {
+		size_t fingerDistance = (llist->fingerIndex > index)
+				? llist->fingerIndex - index
+				: index - llist->fingerIndex;
+
+		if (fingerDistance < distance) {
+			node = llist->finger;
+			nodeIndex = llist->fingerIndex;
+		}
+	}
+
+	for (; nodeIndex < index; nodeIndex++) {
+		node = node->next;
+	}
+	for (; nodeIndex > index; nodeIndex--) {
+		node = node->prev;
+	}
+
+	llist->finger = node;
+	llist->fingerIndex = index;
+
+	*cursor = node;
 	return 0;
 }
 
 
+int
+llistCursor_seek(LinkedList *llist, struct Node **cursor, size_t index) {
+	int result;
+
+	TRACE_CALL(LLIST_OP_SEEK, llist, result = seekIndex(llist, cursor, index));
+	return result;
+}
+
+
+/* Safe for epoch readers (see llist_enableEpochs), hence no assertList */
 int
 llistCursor_getTail(LinkedList *llist, struct Node **cursor) {
-	assertList(llist);
+	assert(llist != NULL);
 
 	if (cursor == NULL) {
 		return -1;
 	}
 
-	*cursor = llist->tail;
+	*cursor = ATOMIC_LOAD_ACQUIRE(&(llist->tail));
 	return 0;
 }
 
 
 int
 llistCursor_getPrev(LinkedList *llist, struct Node **cursor) {
+	struct Node *prev;
 
 	if (!isUserPointerValid(cursor)) {
 		return -2;
 	}
 
-	if ((*cursor)->prev == NULL) {
+	prev = ATOMIC_LOAD_ACQUIRE(&((*cursor)->prev));
+	if (prev == NULL) {
 		return -1;
 	}
-	*cursor = (*cursor)->prev;
+	*cursor = prev;
 	return 0;
 }
 
 
 int
 llistCursor_getNext(LinkedList *llist, struct Node **cursor) {
+	struct Node *next;
 
 	if (!isUserPointerValid(cursor)) {
 		return -2;
 	}
 
-	if ((*cursor)->next == NULL) {
+	next = ATOMIC_LOAD_ACQUIRE(&((*cursor)->next));
+	if (next == NULL) {
 		return -1;
 	}
-
-	*cursor = (*cursor)->next;
+	*cursor = next;
 	return 0;
 }
 /* === END Cursor functions === */
@@ -7,6 +7,7 @@
 #define LINKED_LIST_H
 
 #include <stdlib.h> /* size_t */
+#include <stdio.h> /* FILE */
 
 typedef enum e_LlistDirection {
 	LLIST_BEFORE = -1,
@@ -18,11 +19,83 @@ typedef enum e_LlistDirection {
 
 typedef int (*nodeDestroyFunc)(void *);
 typedef int (*nodeCmpFunc)(void *, void *);
+typedef size_t (*nodeHashFunc)(void *);
+typedef unsigned long (*nodeKeyFunc)(void *);
+
+/* Bulk traversals (llist_forEach, llist_mapInPlace, llist_reduce), the last argument is the caller's context */
+typedef int (*nodeVisitFunc)(void *, void *);
+typedef void *(*nodeMapFunc)(void *, void *);
+typedef void (*nodeReduceFunc)(void *acc, void *, void *);
+typedef void (*nodeCombineFunc)(void *acc, void *partial, void *);
+
+typedef void *(*llistAllocFunc)(void *context, size_t size);
+typedef void (*llistFreeFunc)(void *context, void *ptr);
+
+
+/* Lets callers plug in their own memory (arenas, huge pages...)
+ * f_free may be NULL when memory is reclaimed all at once (e.g. by resetting an arena)
+ */
+typedef struct s_LlistAllocator {
+	llistAllocFunc f_alloc;
+	llistFreeFunc f_free;
+	void *context;
+} LlistAllocator;
+
+
+/* Operation counters, only kept when the library is built with LLIST_STATS
+ * defined (see llist_getStats)
+ */
+typedef struct s_LlistStats {
+	size_t nbCmps;
+	size_t nbTraversed;
+	size_t nbAllocs;
+	size_t nbFrees;
+	size_t nbSwaps;
+	size_t peakSize;
+} LlistStats;
 
 
 /* Forward declare and typedef internal structs (since callers shouldn't know the internals) */
 typedef struct Node *LlistCursor;
 typedef struct s_LinkedList LinkedList;
+typedef struct s_LlistReader LlistReader;
+
+
+/* Functions timed when the library is built with LLIST_TRACE defined (see llist_setTraceHooks) */
+typedef enum e_LlistOp {
+	LLIST_OP_DESTROY,
+	LLIST_OP_INSERT_HEAD,
+	LLIST_OP_INSERT_TAIL,
+	LLIST_OP_INSERT_DATA,
+	LLIST_OP_INSERT_SORTED,
+	LLIST_OP_POP_NODE,
+	LLIST_OP_REMOVE_NODE,
+	LLIST_OP_POP_HEAD,
+	LLIST_OP_POP_TAIL,
+	LLIST_OP_FIND,
+	LLIST_OP_COUNT_MATCH,
+	LLIST_OP_SEEK,
+	LLIST_OP_MERGE_SORT,
+	LLIST_OP_PARALLEL_SORT,
+	LLIST_OP_SORT_BY_KEY,
+	LLIST_NB_OPS
+} LlistOp;
+
+
+/* Bucket i counts the calls which took [2^i, 2^(i + 1)) ns, the last one also counts slower calls */
+#define LLIST_LATENCY_BUCKETS 32
+
+typedef struct s_LlistLatency {
+	size_t nbCalls;
+	size_t totalNs;
+	size_t buckets[LLIST_LATENCY_BUCKETS];
+} LlistLatency;
+
+
+/* Called around each timed function, ns is 0 when beginning. llist only
+ * identifies the list (it is already gone when llist_destroy ends)
+ */
+typedef void (*llistTraceFunc)(LlistOp op, LinkedList *llist, size_t ns, void *context);
 
 
 
@@ -31,19 +104,65 @@ typedef struct s_LinkedList LinkedList;
 LinkedList *
 llist_new(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode);
 
+LinkedList *
+llist_newPooled(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode, size_t chunkNodes);
+
+LinkedList *
+llist_newWithAllocator(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode, const LlistAllocator *allocator);
+
+LinkedList *
+llist_newOrdered(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode);
+
 
 int
 llist_destroy(LinkedList **p_llist);
 
+
+int
+llist_enableIndex(LinkedList *llist, nodeHashFunc f_hashNode);
+
+int
+llist_disableIndex(LinkedList *llist);
+
+int
+llist_setKeyFunc(LinkedList *llist, nodeKeyFunc f_keyNode, int b_exactKey);
+
+int
+llist_enableEpochs(LinkedList *llist);
+
 /* === END ctor/dtor === */
 
 
 
+/* === Epoch reader functions === */
+
+LlistReader *
+llist_newReader(LinkedList *llist);
+
+int
+llist_destroyReader(LlistReader **p_reader);
+
+void
+llist_readBegin(LinkedList *llist, LlistReader *reader);
+
+void
+llist_readEnd(LinkedList *llist, LlistReader *reader);
+
+int
+llist_synchronize(LinkedList *llist);
+
+/* === END Epoch reader functions === */
+
+
+
 /* === cursor functions === */
 
 LlistCursor *
 llistCursor_new(void);
 
+LlistCursor *
+llistCursor_newWithAllocator(const LlistAllocator *allocator);
+
 LlistCursor *
 llistCursor_copy(LlistCursor *);
 
@@ -77,6 +196,9 @@ llistCursor_getHead(LinkedList *llist, LlistCursor *cursor);
 int
 llistCursor_getTail(LinkedList *llist, LlistCursor *cursor);
 
+int
+llistCursor_seek(LinkedList *llist, LlistCursor *cursor, size_t index);
+
 int
 llistCursor_isTail(LinkedList *llist, LlistCursor *cursor);
 
@@ -92,6 +214,9 @@ llistCursor_insertData(LinkedList *llist, LlistCursor *cursor, void *data, Llist
 
 /* === Query functions === */
 
+size_t
+llist_size(LinkedList *llist);
+
 size_t
 llist_countMatch(LinkedList *llist, void *data);
 
@@ -104,12 +229,128 @@ llist_getTailData(LinkedList *llist);
 /* === END Query functions === */
 
 
+/* === Stats functions === */
+int
+llist_getStats(LinkedList *llist, LlistStats *stats);
+
+void
+llist_resetStats(LinkedList *llist);
+
+/* === END Stats functions === */
+
+
+/* === Trace functions === */
+int
+llist_setTraceHooks(llistTraceFunc f_begin, llistTraceFunc f_end, void *context);
+
+int
+llist_getLatency(LlistOp op, LlistLatency *latency);
+
+void
+llist_resetLatency(void);
+
+int
+llist_dumpLatency(FILE *out);
+
+const char *
+llist_opName(LlistOp op);
+
+/* === END Trace functions === */
+
+
 /* === Mutator functions === */
 int
 llist_bubbleSort(LinkedList *llist);
+
+int
+llist_mergeSort(LinkedList *llist);
+
+int
+llist_parallelSort(LinkedList *llist, size_t nbThreads);
+
+int
+llist_sortByKey(LinkedList *llist, nodeKeyFunc f_keyNode);
+
+int
+llist_compact(LinkedList *llist, LlistCursor **cursors, size_t nbCursors);
 /* === END Mutator functions === */
 
 
+/* === Sorted functions === */
+int
+llist_insertSorted(LinkedList *llist, void *data);
+
+int
+llist_lowerBound(LinkedList *llist, LlistCursor *cursor, void *data);
+
+int
+llist_upperBound(LinkedList *llist, LlistCursor *cursor, void *data);
+
+/* === END Sorted functions === */
+
+
+/* === Splice functions === */
+int
+llist_concat(LinkedList *dst, LinkedList *src);
+
+int
+llist_mergeSorted(LinkedList *dst, LinkedList *src);
+
+int
+llist_mergeK(LinkedList **lists, size_t k);
+
+int
+llist_splice(LinkedList *dst, LlistCursor *dstCursor, LinkedList *src,
+		LlistCursor *firstCursor, LlistCursor *lastCursor, LlistDirection dir);
+
+LinkedList *
+llist_splitAt(LinkedList *llist, LlistCursor *cursor);
+
+/* === END Splice functions === */
+
+
+/* === Set functions === */
+int
+llist_setUnion(LinkedList *dst, LinkedList *src);
+
+int
+llist_setIntersect(LinkedList *dst, LinkedList *src);
+
+int
+llist_setDifference(LinkedList *dst, LinkedList *src);
+
+int
+llist_unique(LinkedList *llist);
+
+int
+llist_uniqueUnordered(LinkedList *llist, nodeHashFunc f_hashNode);
+
+int
+llist_groupBy(LinkedList *llist, nodeHashFunc f_hashNode, LinkedList ***p_groups, size_t *p_nbGroups);
+
+/* === END Set functions === */
+
+
+/* === Bulk functions === */
+int
+llist_forEach(LinkedList *llist, size_t nbThreads, nodeVisitFunc f_visit, void *context);
+
+int
+llist_mapInPlace(LinkedList *llist, size_t nbThreads, nodeMapFunc f_map, void *context);
+
+int
+llist_reduce(LinkedList *llist, size_t nbThreads, nodeReduceFunc f_reduce, nodeCombineFunc f_combine,
+		void *acc, size_t accSize, void *context);
+
+size_t
+llist_parallelCountMatch(LinkedList *llist, void *data, size_t nbThreads);
+
+void
+llist_stopWorkers(void);
+
+/* === END Bulk functions === */
+
+
 /* === Insert functions === */
 int
 llist_insertHead(LinkedList *llist, void *data);
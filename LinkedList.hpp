@@ -0,0 +1,521 @@
+/*
+ * Header-only C++11 wrapper: llist::list<T, Alloc> owns a LinkedList whose
+ * data pointers point to Ts constructed in place with Alloc, and whose Nodes
+ * are allocated with Alloc too (rebound, through an LlistAllocator).
+ *
+ * Iterators are bidirectional and walk the list with the cursor functions.
+ * Lists are move-only. sort() and splice() call llist_mergeSort and
+ * llist_splice/llist_concat, so they relink Nodes instead of moving values.
+ *
+ * Comparators given to sort() must not throw (they run under C code).
+ */
+
+#ifndef LINKED_LIST_HPP
+#define LINKED_LIST_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+extern "C" {
+#include "LinkedList.h"
+}
+
+
+namespace llist {
+
+template <class T, class Alloc = std::allocator<T> >
+class list {
+	typedef std::allocator_traits<Alloc> ValueTraits;
+
+	/* Nodes are carved from blocks of max_align_t, the first one holding the
+	 * block's length since LlistAllocator's f_free doesn't get the size */
+	typedef typename ValueTraits::template rebind_alloc<std::max_align_t> BlockAlloc;
+	typedef std::allocator_traits<BlockAlloc> BlockTraits;
+
+	/* Stateless allocators share a NULL context, so that lists of the same
+	 * type allocate Nodes the same way and can splice from one another */
+	static const bool b_stateless = std::is_empty<BlockAlloc>::value;
+
+	/* Comparator of the running sort(), see cmpData */
+	struct SortContext {
+		const void *comp;
+		bool (*f_less)(const void *comp, const T &a, const T &b);
+	};
+
+	template <bool b_const>
+	class basic_iterator {
+		friend class list;
+		template <bool> friend class basic_iterator;
+
+		LinkedList *llist_;
+		LlistCursor node_;
+
+		basic_iterator(LinkedList *llist, LlistCursor node) : llist_(llist), node_(node) {}
+
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef typename std::conditional<b_const, const T *, T *>::type pointer;
+		typedef typename std::conditional<b_const, const T &, T &>::type reference;
+
+		basic_iterator() : llist_(NULL), node_(NULL) {}
+
+		/* iterator converts to const_iterator */
+		template <bool b_otherConst, class = typename std::enable_if<b_const && !b_otherConst>::type>
+		basic_iterator(const basic_iterator<b_otherConst> &other) : llist_(other.llist_), node_(other.node_) {}
+
+		reference
+		operator*() const {
+			LlistCursor node = node_;
+
+			return *static_cast<pointer>(llistCursor_getData(llist_, &node));
+		}
+
+		pointer
+		operator->() const {
+			return &(**this);
+		}
+
+		basic_iterator &
+		operator++() {
+			if (llistCursor_getNext(llist_, &node_) != 0) {
+				node_ = NULL;
+			}
+			return *this;
+		}
+
+		basic_iterator
+		operator++(int) {
+			basic_iterator old = *this;
+
+			++*this;
+			return old;
+		}
+
+		/* end() goes back to the tail */
+		basic_iterator &
+		operator--() {
+			if (node_ == NULL) {
+				llistCursor_getTail(llist_, &node_);
+			} else {
+				llistCursor_getPrev(llist_, &node_);
+			}
+			return *this;
+		}
+
+		basic_iterator
+		operator--(int) {
+			basic_iterator old = *this;
+
+			--*this;
+			return old;
+		}
+
+		template <bool b_otherConst>
+		bool
+		operator==(const basic_iterator<b_otherConst> &other) const {
+			return node_ == other.node_;
+		}
+
+		template <bool b_otherConst>
+		bool
+		operator!=(const basic_iterator<b_otherConst> &other) const {
+			return node_ != other.node_;
+		}
+	};
+
+public:
+	typedef T value_type;
+	typedef Alloc allocator_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef T &reference;
+	typedef const T &const_reference;
+	typedef basic_iterator<false> iterator;
+	typedef basic_iterator<true> const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+
+	/* === ctor/dtor === */
+
+	explicit
+	list(const Alloc &alloc = Alloc()) : alloc_(alloc), blockAlloc_(NULL), llist_(NULL) {
+		LlistAllocator allocator;
+
+		if (!b_stateless) {
+			blockAlloc_ = new BlockAlloc(alloc_);
+		}
+		allocator.f_alloc = allocBlock;
+		allocator.f_free = freeBlock;
+		allocator.context = blockAlloc_;
+
+		llist_ = llist_newWithAllocator(NULL, cmpData, &allocator);
+		if (llist_ == NULL) {
+			delete blockAlloc_;
+			throw std::bad_alloc();
+		}
+	}
+
+	/* A moved-from list can only be destroyed or assigned to */
+	list(list &&other) noexcept : alloc_(std::move(other.alloc_)), blockAlloc_(other.blockAlloc_), llist_(other.llist_) {
+		other.blockAlloc_ = NULL;
+		other.llist_ = NULL;
+	}
+
+	list &
+	operator=(list &&other) noexcept {
+		if (this != &other) {
+			release();
+			alloc_ = std::move(other.alloc_);
+			blockAlloc_ = other.blockAlloc_, other.blockAlloc_ = NULL;
+			llist_ = other.llist_, other.llist_ = NULL;
+		}
+		return *this;
+	}
+
+	list(const list &) = delete;
+	list &operator=(const list &) = delete;
+
+	~list() {
+		release();
+	}
+
+	/* === END ctor/dtor === */
+
+
+	/* === Query functions === */
+
+	allocator_type get_allocator() const { return alloc_; }
+
+	/* The wrapped list, its data pointers point to Ts and its f_cmpNode
+	 * compares them with < (== for Ts without <, see cmpData) */
+	LinkedList *native() const { return llist_; }
+
+	bool empty() const { return llist_ == NULL || begin() == end(); }
+	size_type size() const { return (llist_ != NULL) ? llist_size(llist_) : 0; }
+
+	reference front() { return *static_cast<T *>(llist_getHeadData(llist_)); }
+	const_reference front() const { return *static_cast<const T *>(llist_getHeadData(llist_)); }
+	reference back() { return *static_cast<T *>(llist_getTailData(llist_)); }
+	const_reference back() const { return *static_cast<const T *>(llist_getTailData(llist_)); }
+
+	iterator
+	begin() {
+		LlistCursor node = NULL;
+
+		llistCursor_getHead(llist_, &node);
+		return iterator(llist_, node);
+	}
+
+	const_iterator begin() const { return const_cast<list *>(this)->begin(); }
+	const_iterator cbegin() const { return begin(); }
+	iterator end() { return iterator(llist_, NULL); }
+	const_iterator end() const { return const_iterator(llist_, NULL); }
+	const_iterator cend() const { return end(); }
+
+	reverse_iterator rbegin() { return reverse_iterator(end()); }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+	reverse_iterator rend() { return reverse_iterator(begin()); }
+	const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+	/* === END Query functions === */
+
+
+	/* === Insert functions === */
+
+	/* Constructs a T from args right before pos */
+	template <class... Args>
+	iterator
+	emplace(const_iterator pos, Args &&... args) {
+		T *value = newValue(std::forward<Args>(args)...);
+		LlistCursor node = pos.node_;
+		int error;
+
+		if (node == NULL) {
+			error = llist_insertTail(llist_, value);
+			llistCursor_getTail(llist_, &node);
+		} else {
+			error = llistCursor_insertData(llist_, &node, value, LLIST_BEFORE);
+			llistCursor_getPrev(llist_, &node);
+		}
+
+		if (error != 0) {
+			destroyValue(value);
+			throw std::bad_alloc();
+		}
+		return iterator(llist_, node);
+	}
+
+	template <class... Args>
+	reference
+	emplace_front(Args &&... args) {
+		return *emplace(begin(), std::forward<Args>(args)...);
+	}
+
+	template <class... Args>
+	reference
+	emplace_back(Args &&... args) {
+		return *emplace(end(), std::forward<Args>(args)...);
+	}
+
+	iterator insert(const_iterator pos, const T &value) { return emplace(pos, value); }
+	iterator insert(const_iterator pos, T &&value) { return emplace(pos, std::move(value)); }
+	void push_front(const T &value) { emplace_front(value); }
+	void push_front(T &&value) { emplace_front(std::move(value)); }
+	void push_back(const T &value) { emplace_back(value); }
+	void push_back(T &&value) { emplace_back(std::move(value)); }
+
+	/* === END Insert functions === */
+
+
+	/* === Delete functions === */
+
+	/* Returns the iterator following pos */
+	iterator
+	erase(const_iterator pos) {
+		LlistCursor node = pos.node_;
+		iterator next(llist_, pos.node_);
+
+		++next;
+		destroyValue(static_cast<T *>(llist_popNode(llist_, &node)));
+		return next;
+	}
+
+	iterator
+	erase(const_iterator first, const_iterator last) {
+		while (first != last) {
+			first = erase(first);
+		}
+		return iterator(llist_, last.node_);
+	}
+
+	void pop_front() { destroyValue(static_cast<T *>(llist_popHead(llist_))); }
+	void pop_back() { destroyValue(static_cast<T *>(llist_popTail(llist_))); }
+
+	void
+	clear() {
+		void *value;
+
+		while ((value = llist_popHead(llist_)) != NULL) {
+			destroyValue(static_cast<T *>(value));
+		}
+	}
+
+	/* === END Delete functions === */
+
+
+	/* === Mutator functions === */
+
+	/* Stable, only relinks Nodes (llist_mergeSort) */
+	void
+	sort() {
+		sort(std::less<T>());
+	}
+
+	template <class Compare>
+	void
+	sort(Compare comp) {
+		SortContext context;
+		const SortContext *outer = sortContext();
+
+		context.comp = &comp;
+		context.f_less = lessThan<Compare>;
+		sortContext() = &context;
+		llist_mergeSort(llist_);
+		sortContext() = outer;
+	}
+
+	/* Moves other's elements before pos, in O(1) when both lists allocate
+	 * Nodes the same way (stateless allocators), moving pointers to the
+	 * elements one by one otherwise (the allocators must then compare equal) */
+	void
+	splice(const_iterator pos, list &other) {
+		if (pos.node_ == NULL && llist_concat(llist_, other.llist_) == 0) {
+			return;
+		}
+		splice(pos, other, other.begin(), other.end());
+	}
+
+	void splice(const_iterator pos, list &&other) { splice(pos, other); }
+
+	/* Moves [first, last) out of other and before pos */
+	void
+	splice(const_iterator pos, list &other, const_iterator first, const_iterator last) {
+		LlistCursor dstNode = pos.node_;
+		LlistCursor firstNode = first.node_;
+		LlistCursor lastNode = last.node_;
+		LlistDirection dir = LLIST_BEFORE;
+
+		if (first == last) {
+			return;
+		}
+		if (lastNode == NULL) {
+			llistCursor_getTail(other.llist_, &lastNode);
+		} else {
+			llistCursor_getPrev(other.llist_, &lastNode);
+		}
+		if (dstNode == NULL) {
+			llistCursor_getTail(llist_, &dstNode);
+			dir = LLIST_AFTER;
+		}
+
+		if (llist_splice(llist_, &dstNode, other.llist_, &firstNode, &lastNode, dir) != 0) {
+			while (first != last) {
+				LlistCursor node = first.node_;
+
+				++first;
+				insertPointer(pos, llist_popNode(other.llist_, &node));
+			}
+		}
+	}
+
+	void splice(const_iterator pos, list &other, const_iterator it) { splice(pos, other, it, std::next(it)); }
+
+	/* === END Mutator functions === */
+
+
+private:
+	Alloc alloc_;
+	BlockAlloc *blockAlloc_;
+	LinkedList *llist_;
+
+
+	static void *
+	allocBlock(void *context, std::size_t size) {
+		BlockAlloc alloc = (context != NULL) ? *static_cast<BlockAlloc *>(context) : BlockAlloc();
+		std::size_t nbUnits = 1 + (size + sizeof (std::max_align_t) - 1) / sizeof (std::max_align_t);
+		std::max_align_t *block;
+
+		try {
+			block = BlockTraits::allocate(alloc, nbUnits);
+		} catch (...) {
+			return NULL;
+		}
+		*reinterpret_cast<std::size_t *>(block) = nbUnits;
+		return block + 1;
+	}
+
+	static void
+	freeBlock(void *context, void *ptr) {
+		BlockAlloc alloc = (context != NULL) ? *static_cast<BlockAlloc *>(context) : BlockAlloc();
+		std::max_align_t *block = static_cast<std::max_align_t *>(ptr) - 1;
+
+		BlockTraits::deallocate(alloc, block, *reinterpret_cast<std::size_t *>(block));
+	}
+
+	/* The running sort() of the calling thread */
+	static const SortContext *&
+	sortContext() {
+		static thread_local const SortContext *context = NULL;
+
+		return context;
+	}
+
+	template <class Compare>
+	static bool
+	lessThan(const void *comp, const T &a, const T &b) {
+		return (*static_cast<const Compare *>(comp))(a, b);
+	}
+
+	/* Detects T's operator< and operator== (only the ones T has get used) */
+	template <class U>
+	static auto hasLess(int) -> decltype(std::declval<const U &>() < std::declval<const U &>(), std::true_type());
+	template <class U>
+	static std::false_type hasLess(...);
+
+	template <class U>
+	static auto hasEqual(int) -> decltype(std::declval<const U &>() == std::declval<const U &>(), std::true_type());
+	template <class U>
+	static std::false_type hasEqual(...);
+
+	static int
+	naturalCmp(const T &a, const T &b, std::true_type /* has < */) {
+		return std::less<T>()(a, b) ? -1 : (std::less<T>()(b, a) ? 1 : 0);
+	}
+
+	static int
+	naturalCmp(const T &a, const T &b, std::false_type /* has < */) {
+		return equalCmp(a, b, decltype(hasEqual<T>(0))());
+	}
+
+	static int
+	equalCmp(const T &a, const T &b, std::true_type /* has == */) {
+		return (a == b) ? 0 : 1;
+	}
+
+	/* Ts which can't be compared never match */
+	static int
+	equalCmp(const T &, const T &, std::false_type /* has == */) {
+		return 1;
+	}
+
+	/* llist_mergeSort only needs to know whether b goes strictly before a.
+	 * Outside of sort() (C functions called on native()), Ts compare with <,
+	 * or with == when T has no < (good enough for searches) */
+	static int
+	cmpData(void *a, void *b) {
+		const SortContext *context = sortContext();
+
+		if (context == NULL) {
+			return naturalCmp(*static_cast<T *>(a), *static_cast<T *>(b), decltype(hasLess<T>(0))());
+		}
+		return context->f_less(context->comp, *static_cast<T *>(b), *static_cast<T *>(a)) ? 1 : 0;
+	}
+
+	template <class... Args>
+	T *
+	newValue(Args &&... args) {
+		T *value = ValueTraits::allocate(alloc_, 1);
+
+		try {
+			ValueTraits::construct(alloc_, value, std::forward<Args>(args)...);
+		} catch (...) {
+			ValueTraits::deallocate(alloc_, value, 1);
+			throw;
+		}
+		return value;
+	}
+
+	void
+	destroyValue(T *value) {
+		if (value != NULL) {
+			ValueTraits::destroy(alloc_, value);
+			ValueTraits::deallocate(alloc_, value, 1);
+		}
+	}
+
+	/* Links an already constructed value before pos */
+	void
+	insertPointer(const_iterator pos, void *value) {
+		LlistCursor node = pos.node_;
+		int error = (node == NULL) ? llist_insertTail(llist_, value)
+				: llistCursor_insertData(llist_, &node, value, LLIST_BEFORE);
+
+		if (error != 0) {
+			destroyValue(static_cast<T *>(value));
+			throw std::bad_alloc();
+		}
+	}
+
+	void
+	release() {
+		if (llist_ != NULL) {
+			clear();
+			llist_destroy(&llist_);
+		}
+		delete blockAlloc_;
+		blockAlloc_ = NULL;
+	}
+};
+
+} /* namespace llist */
+
+#endif /* Guard */
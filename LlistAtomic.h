@@ -0,0 +1,28 @@
+/*
+ * Internal header: atomic operations for the concurrent parts of the library.
+ *
+ * These map to the GCC/Clang __atomic builtins, which follow the C11 memory
+ * model, so that the code can keep building as ANSI C.
+ */
+
+#ifndef LLIST_ATOMIC_H
+#define LLIST_ATOMIC_H
+
+#define ATOMIC_LOAD(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define ATOMIC_LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_LOAD_RELAXED(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+
+#define ATOMIC_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define ATOMIC_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ATOMIC_STORE_RELAXED(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+
+#define ATOMIC_FETCH_ADD(p, v) __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+#define ATOMIC_FETCH_ADD_RELAXED(p, v) __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+
+/* p_expected points to a local copy of the value *p is expected to hold */
+#define ATOMIC_CAS(p, p_expected, desired) \
+	__atomic_compare_exchange_n((p), (p_expected), (desired), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+
+#define ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#endif /* Guard */
@@ -0,0 +1,231 @@
+/*
+ * Work-stealing thread pool, see LlistPool.h
+ *
+ * A job's chunks are split into one contiguous range per thread taking part.
+ * Threads take chunks from the front of their own range and, once it is empty,
+ * steal from the back of the others' so that a thread stuck on slow chunks
+ * doesn't hold the whole job back. Ranges are tiny and rarely contended, so a
+ * mutex per range is enough.
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "LlistPool.h"
+
+
+#define LLIST_POOL_MAX_THREADS 256
+
+
+struct ChunkRange {
+	pthread_mutex_t lock;
+	size_t begin;
+	size_t end;
+};
+
+
+struct Worker {
+	pthread_t thread;
+	size_t id;
+	size_t seenGeneration;
+};
+
+
+struct WorkerPool {
+	struct Worker workers[LLIST_POOL_MAX_THREADS];
+	size_t nbWorkers;
+	size_t generation;
+	int b_shutdown;
+
+	/* Current job, the calling thread is participant 0 and worker i is i + 1 */
+	size_t nbParticipants;
+	size_t nbFinished;
+	struct ChunkRange *ranges;
+	poolChunkFunc f_runChunk;
+	void *job;
+};
+
+
+/* poolLock protects everything in pool but the ranges, poolJobLock lets one job in at a time */
+static pthread_mutex_t poolJobLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t poolWake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t poolDone = PTHREAD_COND_INITIALIZER;
+static struct WorkerPool pool;
+
+/* Set while the thread runs chunks of a job: jobs started from a chunk run
+ * inline, as the pool is busy with the job they are part of (GCC extension,
+ * like the atomics of LlistAtomic.h) */
+static __thread int b_inJob = 0;
+
+
+
+/* === Internal functions === */
+static int
+takeChunk(size_t self, size_t *p_chunk) {
+	struct ChunkRange *range = &(pool.ranges[self]);
+	size_t i;
+
+	pthread_mutex_lock(&(range->lock));
+	if (range->begin < range->end) {
+		*p_chunk = range->begin++;
+		pthread_mutex_unlock(&(range->lock));
+		return 1;
+	}
+	pthread_mutex_unlock(&(range->lock));
+
+	for (i = 1; i < pool.nbParticipants; i++) {
+		range = &(pool.ranges[(self + i) % pool.nbParticipants]);
+
+		pthread_mutex_lock(&(range->lock));
+		if (range->begin < range->end) {
+			*p_chunk = --range->end;
+			pthread_mutex_unlock(&(range->lock));
+			return 1;
+		}
+		pthread_mutex_unlock(&(range->lock));
+	}
+
+	return 0;
+}
+
+
+static void
+runParticipant(size_t self) {
+	size_t chunk;
+
+	while (takeChunk(self, &chunk)) {
+		pool.f_runChunk(pool.job, chunk);
+	}
+}
+
+
+static void *
+workerMain(void *arg) {
+	struct Worker *worker = arg;
+
+	/* Workers only ever run chunks */
+	b_inJob = 1;
+	pthread_mutex_lock(&poolLock);
+	for (;;) {
+		while (pool.generation == worker->seenGeneration && !pool.b_shutdown) {
+			pthread_cond_wait(&poolWake, &poolLock);
+		}
+		if (pool.b_shutdown) {
+			break;
+		}
+		worker->seenGeneration = pool.generation;
+
+		if (worker->id + 1 < pool.nbParticipants) {
+			pthread_mutex_unlock(&poolLock);
+			runParticipant(worker->id + 1);
+			pthread_mutex_lock(&poolLock);
+
+			if (++pool.nbFinished == pool.nbParticipants - 1) {
+				pthread_cond_signal(&poolDone);
+			}
+		}
+	}
+	pthread_mutex_unlock(&poolLock);
+
+	return NULL;
+}
+
+/* === END Internal functions === */
+
+
+
+size_t
+llistPool_run(size_t nbThreads, size_t nbChunks, poolChunkFunc f_runChunk, void *job) {
+	struct ChunkRange *ranges;
+	size_t i, nbParticipants;
+
+	if (nbThreads > nbChunks) {
+		nbThreads = nbChunks;
+	}
+	if (nbThreads > LLIST_POOL_MAX_THREADS) {
+		nbThreads = LLIST_POOL_MAX_THREADS;
+	}
+
+	ranges = (nbThreads > 1 && !b_inJob) ? malloc(nbThreads * sizeof (*ranges)) : NULL;
+	if (ranges == NULL) {
+		for (i = 0; i < nbChunks; i++) {
+			f_runChunk(job, i);
+		}
+		return 1;
+	}
+
+	pthread_mutex_lock(&poolJobLock);
+	pthread_mutex_lock(&poolLock);
+
+	/* New workers start with the current generation so they wait for this job */
+	while (pool.nbWorkers + 1 < nbThreads) {
+		struct Worker *worker = &(pool.workers[pool.nbWorkers]);
+
+		worker->id = pool.nbWorkers;
+		worker->seenGeneration = pool.generation;
+		if (pthread_create(&(worker->thread), NULL, workerMain, worker) != 0) {
+			break;
+		}
+		pool.nbWorkers++;
+	}
+
+	nbParticipants = (pool.nbWorkers + 1 < nbThreads) ? pool.nbWorkers + 1 : nbThreads;
+	for (i = 0; i < nbParticipants; i++) {
+		pthread_mutex_init(&(ranges[i].lock), NULL);
+		ranges[i].begin = i * nbChunks / nbParticipants;
+		ranges[i].end = (i + 1) * nbChunks / nbParticipants;
+	}
+
+	pool.nbParticipants = nbParticipants;
+	pool.nbFinished = 0;
+	pool.ranges = ranges;
+	pool.f_runChunk = f_runChunk;
+	pool.job = job;
+	pool.generation++;
+	pthread_cond_broadcast(&poolWake);
+	pthread_mutex_unlock(&poolLock);
+
+	b_inJob = 1;
+	runParticipant(0);
+	b_inJob = 0;
+
+	pthread_mutex_lock(&poolLock);
+	while (pool.nbFinished < nbParticipants - 1) {
+		pthread_cond_wait(&poolDone, &poolLock);
+	}
+	pool.ranges = NULL;
+	pthread_mutex_unlock(&poolLock);
+	pthread_mutex_unlock(&poolJobLock);
+
+	for (i = 0; i < nbParticipants; i++) {
+		pthread_mutex_destroy(&(ranges[i].lock));
+	}
+	free(ranges);
+
+	return nbParticipants;
+}
+
+
+void
+llistPool_shutdown(void) {
+	size_t i;
+
+	pthread_mutex_lock(&poolJobLock);
+
+	pthread_mutex_lock(&poolLock);
+	pool.b_shutdown = 1;
+	pthread_cond_broadcast(&poolWake);
+	pthread_mutex_unlock(&poolLock);
+
+	for (i = 0; i < pool.nbWorkers; i++) {
+		pthread_join(pool.workers[i].thread, NULL);
+	}
+
+	pthread_mutex_lock(&poolLock);
+	pool.nbWorkers = 0;
+	pool.b_shutdown = 0;
+	pthread_mutex_unlock(&poolLock);
+
+	pthread_mutex_unlock(&poolJobLock);
+}
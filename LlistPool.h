@@ -0,0 +1,39 @@
+/*
+ * Internal header: the library's work-stealing thread pool, which runs the
+ * bulk traversals of LinkedList.c (llist_forEach and friends).
+ *
+ * Worker threads are created on first use, kept around for the next jobs
+ * and only ever added when a job asks for more threads than there are.
+ */
+
+#ifndef LLIST_POOL_H
+#define LLIST_POOL_H
+
+#include <stdlib.h> /* size_t */
+
+
+/* Runs one chunk of a job, chunks can run in any order and on any thread */
+typedef void (*poolChunkFunc)(void *job, size_t chunk);
+
+
+/*
+ * llistPool_run
+ *
+ * Runs f_runChunk(job, chunk) for every chunk in [0, nbChunks) on up to
+ * nbThreads threads, the calling thread included, and returns once they all
+ * ran. Each thread starts on its own contiguous range of chunks and steals
+ * from the end of the others' ranges once its own is done.
+ *
+ * Jobs from several threads at once run one after the other. A job started
+ * from one of f_runChunk's calls runs all of its chunks on the calling thread.
+ * Returns the number of threads which took part
+ */
+size_t
+llistPool_run(size_t nbThreads, size_t nbChunks, poolChunkFunc f_runChunk, void *job);
+
+
+/* Joins every worker thread (new ones get created by the next job) */
+void
+llistPool_shutdown(void);
+
+#endif /* Guard */
@@ -0,0 +1,245 @@
+/*
+ * Tracing layer, see LlistTrace.h
+ *
+ * Every timed call lands in a log2 histogram of its function, kept for the
+ * whole process. Histograms are only ever incremented (with relaxed atomics)
+ * so that lists used from different threads don't need any lock to be timed.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "LinkedList.h"
+#include "LlistAtomic.h"
+#include "LlistTrace.h"
+
+
+static const char *opNames[LLIST_NB_OPS] = {
+	"destroy",
+	"insertHead",
+	"insertTail",
+	"insertData",
+	"insertSorted",
+	"popNode",
+	"removeNode",
+	"popHead",
+	"popTail",
+	"find",
+	"countMatch",
+	"seek",
+	"mergeSort",
+	"parallelSort",
+	"sortByKey"
+};
+
+
+#ifdef LLIST_TRACE
+
+static LlistLatency latencies[LLIST_NB_OPS];
+
+static llistTraceFunc f_beginHook = NULL;
+static llistTraceFunc f_endHook = NULL;
+static void *hookContext = NULL;
+
+
+
+/* === Internal functions === */
+static double
+nowNs(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+
+static size_t
+bucketOf(size_t ns) {
+	size_t bucket = 0;
+
+	while (ns > 1 && bucket + 1 < LLIST_LATENCY_BUCKETS) {
+		ns >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+
+/* Upper bound of the bucket holding the call slower than fraction of the
+ * others (the lower bound for the last bucket, which has none) */
+static size_t
+percentileNs(const LlistLatency *latency, double fraction) {
+	size_t rank = (size_t)(latency->nbCalls * fraction);
+	size_t seen = 0;
+	size_t i;
+
+	if (rank >= latency->nbCalls) {
+		rank = latency->nbCalls - 1;
+	}
+	for (i = 0; i + 1 < LLIST_LATENCY_BUCKETS; i++) {
+		seen += latency->buckets[i];
+		if (seen > rank) {
+			return (size_t)2 << i;
+		}
+	}
+	return (size_t)1 << i;
+}
+
+
+double
+llistTrace_begin(LlistOp op, LinkedList *llist) {
+	if (f_beginHook != NULL) {
+		f_beginHook(op, llist, 0, hookContext);
+	}
+	return nowNs();
+}
+
+
+void
+llistTrace_end(LlistOp op, LinkedList *llist, double start) {
+	double elapsed = nowNs() - start;
+	size_t ns = (elapsed > 0) ? (size_t)elapsed : 0;
+	LlistLatency *latency = &latencies[op];
+
+	ATOMIC_FETCH_ADD_RELAXED(&(latency->nbCalls), 1);
+	ATOMIC_FETCH_ADD_RELAXED(&(latency->totalNs), ns);
+	ATOMIC_FETCH_ADD_RELAXED(&(latency->buckets[bucketOf(ns)]), 1);
+
+	if (f_endHook != NULL) {
+		f_endHook(op, llist, ns, hookContext);
+	}
+}
+
+#endif /* LLIST_TRACE */
+
+
+
+/* === Trace functions === */
+
+/*
+ * llist_setTraceHooks
+ *
+ * Has f_begin and f_end (either can be NULL) called with context around every
+ * timed function, on the calling thread. Hooks must be set before lists get
+ * used from other threads.
+ *
+ * Returns 0, or -2 when the library wasn't built with LLIST_TRACE
+ */
+int
+llist_setTraceHooks(llistTraceFunc f_begin, llistTraceFunc f_end, void *context) {
+#ifdef LLIST_TRACE
+	f_beginHook = f_begin;
+	f_endHook = f_end;
+	hookContext = context;
+	return 0;
+#else
+	(void)f_begin, (void)f_end, (void)context;
+	return -2;
+#endif
+}
+
+
+/* Copies op's histogram into *latency
+ * Returns 0, -1 if op is invalid, -2 when the library wasn't built with
+ * LLIST_TRACE (*latency is then all zeros)
+ */
+int
+llist_getLatency(LlistOp op, LlistLatency *latency) {
+	memset(latency, 0, sizeof (*latency));
+	if ((int)op < 0 || op >= LLIST_NB_OPS) {
+		return -1;
+	}
+
+#ifdef LLIST_TRACE
+	{
+		size_t i;
+
+		latency->nbCalls = ATOMIC_LOAD_RELAXED(&(latencies[op].nbCalls));
+		latency->totalNs = ATOMIC_LOAD_RELAXED(&(latencies[op].totalNs));
+		for (i = 0; i < LLIST_LATENCY_BUCKETS; i++) {
+			latency->buckets[i] = ATOMIC_LOAD_RELAXED(&(latencies[op].buckets[i]));
+		}
+	}
+	return 0;
+#else
+	return -2;
+#endif
+}
+
+
+/* Empties every histogram (calls running meanwhile may or may not be kept) */
+void
+llist_resetLatency(void) {
+#ifdef LLIST_TRACE
+	size_t op, i;
+
+	for (op = 0; op < LLIST_NB_OPS; op++) {
+		ATOMIC_STORE_RELAXED(&(latencies[op].nbCalls), 0);
+		ATOMIC_STORE_RELAXED(&(latencies[op].totalNs), 0);
+		for (i = 0; i < LLIST_LATENCY_BUCKETS; i++) {
+			ATOMIC_STORE_RELAXED(&(latencies[op].buckets[i]), 0);
+		}
+	}
+#endif
+}
+
+
+/*
+ * llist_dumpLatency
+ *
+ * Writes one line per function called so far to out: its number of calls,
+ * mean latency and p50/p99/p99.9/max latencies (upper bounds of their
+ * histogram buckets), all in ns
+ *
+ * Returns 0, -1 on write errors, -2 when the library wasn't built with LLIST_TRACE
+ */
+int
+llist_dumpLatency(FILE *out) {
+#ifdef LLIST_TRACE
+	size_t op;
+
+	if (fprintf(out, "%-14s %10s %10s %10s %10s %10s %10s\n",
+			"op", "calls", "mean_ns", "p50_ns", "p99_ns", "p99.9_ns", "max_ns") < 0) {
+		return -1;
+	}
+
+	for (op = 0; op < LLIST_NB_OPS; op++) {
+		LlistLatency latency;
+
+		llist_getLatency((LlistOp)op, &latency);
+		if (latency.nbCalls == 0) {
+			continue;
+		}
+
+		if (fprintf(out, "%-14s %10lu %10lu %10lu %10lu %10lu %10lu\n", opNames[op],
+				(unsigned long)latency.nbCalls,
+				(unsigned long)(latency.totalNs / latency.nbCalls),
+				(unsigned long)percentileNs(&latency, 0.5),
+				(unsigned long)percentileNs(&latency, 0.99),
+				(unsigned long)percentileNs(&latency, 0.999),
+				(unsigned long)percentileNs(&latency, 1.0)) < 0) {
+			return -1;
+		}
+	}
+	return 0;
+#else
+	(void)out;
+	return -2;
+#endif
+}
+
+
+/* Name of op for reports ("find", "popHead"...), NULL if op is invalid */
+const char *
+llist_opName(LlistOp op) {
+	if ((int)op < 0 || op >= LLIST_NB_OPS) {
+		return NULL;
+	}
+	return opNames[op];
+}
+
+/* === END Trace functions === */
@@ -0,0 +1,21 @@
+/*
+ * Internal header: the tracing layer of the library (see llist_setTraceHooks),
+ * only used by LinkedList.c when it is built with LLIST_TRACE defined.
+ */
+
+#ifndef LLIST_TRACE_H
+#define LLIST_TRACE_H
+
+#include "LinkedList.h"
+
+
+/* Fires the begin hook and returns the start time to give to llistTrace_end */
+double
+llistTrace_begin(LlistOp op, LinkedList *llist);
+
+
+/* Records the time since start in op's histogram and fires the end hook */
+void
+llistTrace_end(LlistOp op, LinkedList *llist, double start);
+
+#endif /* Guard */
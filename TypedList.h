@@ -0,0 +1,340 @@
+/*
+ * Type-specialized lists generated at compile time: values of type T are
+ * stored inline in the Nodes (one allocation per element, no void * payload)
+ * and compared with cmp, which the compiler can inline. The API follows
+ * LinkedList's and IntrusiveList's, positions being Node pointers.
+ *
+ * In a header:
+ *     LLIST_DECLARE(IntList, int);
+ *
+ * In one source file:
+ *     #define INT_CMP(a, b) (((a) > (b)) - ((a) < (b)))
+ *     LLIST_DEFINE(IntList, int, INT_CMP);
+ *
+ * which gives the IntList type, IntListNode (whose data member holds the
+ * value) and IntList_new, IntList_insertTail, IntList_find...
+ *
+ * cmp(a, b) gets two T values and returns <0, 0 or >0 like nodeCmpFunc, it
+ * can be a macro (its arguments have no side effects) or a function.
+ */
+
+#ifndef TYPED_LIST_H
+#define TYPED_LIST_H
+
+#include <stdlib.h> /* size_t, malloc */
+#include <assert.h>
+
+#include "LinkedList.h" /* LlistDirection */
+
+
+/*
+ * LLIST_DECLARE
+ *
+ * Declares the types and functions of name, a list of T. When given a NULL
+ * Node, name_find starts from the head (LLIST_AFTER) or the tail (LLIST_BEFORE)
+ * and name_insert inserts at the tail (LLIST_AFTER) or the head (LLIST_BEFORE).
+ * name_pop* store the popped value in *p_value (when it isn't NULL) and return
+ * -1 when there is no Node to pop
+ */
+#define LLIST_DECLARE(name, T) \
+	typedef struct s_##name##Node name##Node; \
+	\
+	struct s_##name##Node { \
+		name##Node *prev; \
+		name##Node *next; \
+		T data; \
+	}; \
+	\
+	typedef struct s_##name { \
+		name##Node *head; \
+		name##Node *tail; \
+		size_t nbNodes; \
+	} name; \
+	\
+	name * \
+	name##_new(void); \
+	\
+	int \
+	name##_destroy(name **p_list); \
+	\
+	size_t \
+	name##_size(name *list); \
+	\
+	name##Node * \
+	name##_getHead(name *list); \
+	\
+	name##Node * \
+	name##_getTail(name *list); \
+	\
+	name##Node * \
+	name##_find(name *list, name##Node *start, T value, LlistDirection searchDir); \
+	\
+	size_t \
+	name##_countMatch(name *list, T value); \
+	\
+	int \
+	name##_mergeSort(name *list); \
+	\
+	int \
+	name##_insertHead(name *list, T value); \
+	\
+	int \
+	name##_insertTail(name *list, T value); \
+	\
+	int \
+	name##_insert(name *list, name##Node *insertPos, T value, LlistDirection dir); \
+	\
+	int \
+	name##_pop(name *list, name##Node *node, T *p_value); \
+	\
+	int \
+	name##_popHead(name *list, T *p_value); \
+	\
+	int \
+	name##_popTail(name *list, T *p_value)
+
+
+/* Defines the functions declared by LLIST_DECLARE(name, T), comparing with cmp
+ * (it ends on a declaration so that it takes a semicolon like LLIST_DECLARE)
+ */
+#define LLIST_DEFINE(name, T, cmp) \
+	name * \
+	name##_new(void) { \
+		name *list = malloc(sizeof (*list)); \
+	\
+		if (list != NULL) { \
+			list->head = list->tail = NULL; \
+			list->nbNodes = 0; \
+		} \
+		return list; \
+	} \
+	\
+	int \
+	name##_destroy(name **p_list) { \
+		name##Node *node; \
+	\
+		if (p_list == NULL || *p_list == NULL) { \
+			return 0; \
+		} \
+		for (node = (*p_list)->head; node != NULL; ) { \
+			name##Node *next = node->next; \
+	\
+			free(node); \
+			node = next; \
+		} \
+		free(*p_list), *p_list = NULL; \
+		return 0; \
+	} \
+	\
+	size_t \
+	name##_size(name *list) { \
+		assert(list != NULL); \
+		return list->nbNodes; \
+	} \
+	\
+	name##Node * \
+	name##_getHead(name *list) { \
+		assert(list != NULL); \
+		return list->head; \
+	} \
+	\
+	name##Node * \
+	name##_getTail(name *list) { \
+		assert(list != NULL); \
+		return list->tail; \
+	} \
+	\
+	name##Node * \
+	name##_find(name *list, name##Node *start, T value, LlistDirection searchDir) { \
+		name##Node *node; \
+	\
+		assert(list != NULL); \
+		if (searchDir != LLIST_BEFORE && searchDir != LLIST_AFTER) { \
+			return NULL; \
+		} \
+		if (start == NULL) { \
+			start = (searchDir == LLIST_AFTER) ? list->head : list->tail; \
+		} \
+		for (node = start; node != NULL; node = (searchDir == LLIST_AFTER) ? node->next : node->prev) { \
+			if (0 == cmp(value, node->data)) { \
+				return node; \
+			} \
+		} \
+		return NULL; \
+	} \
+	\
+	size_t \
+	name##_countMatch(name *list, T value) { \
+		name##Node *node; \
+		size_t count = 0; \
+	\
+		assert(list != NULL); \
+		for (node = list->head; node != NULL; node = node->next) { \
+			if (0 == cmp(value, node->data)) { \
+				count++; \
+			} \
+		} \
+		return count; \
+	} \
+	\
+	static name##Node * \
+	name##MergeChains(name##Node *left, name##Node *right) { \
+		name##Node *head = NULL; \
+		name##Node **p_link = &head; \
+	\
+		while (left != NULL && right != NULL) { \
+			if (cmp(left->data, right->data) <= 0) { \
+				*p_link = left; \
+				left = left->next; \
+			} else { \
+				*p_link = right; \
+				right = right->next; \
+			} \
+			p_link = &((*p_link)->next); \
+		} \
+		*p_link = (left != NULL) ? left : right; \
+		return head; \
+	} \
+	\
+	int \
+	name##_mergeSort(name *list) { \
+		name##Node *runs = NULL; \
+		name##Node **p_lastRun = &runs; \
+		name##Node *node, *prev; \
+	\
+		assert(list != NULL); \
+		for (node = list->head; node != NULL; ) { \
+			name##Node *runHead = node; \
+	\
+			while (node->next != NULL && cmp(node->data, node->next->data) <= 0) { \
+				node = node->next; \
+			} \
+			*p_lastRun = runHead; \
+			p_lastRun = &(runHead->prev); \
+			runHead = node->next; \
+			node->next = NULL; \
+			node = runHead; \
+		} \
+		*p_lastRun = NULL; \
+	\
+		while (runs != NULL && runs->prev != NULL) { \
+			name##Node *merged = NULL; \
+			name##Node **p_merged = &merged; \
+			name##Node *run = runs; \
+	\
+			while (run != NULL) { \
+				name##Node *left = run; \
+				name##Node *right = left->prev; \
+	\
+				if (right == NULL) { \
+					run = NULL; \
+				} else { \
+					run = right->prev; \
+					left = name##MergeChains(left, right); \
+				} \
+				*p_merged = left; \
+				p_merged = &(left->prev); \
+			} \
+			*p_merged = NULL; \
+			runs = merged; \
+		} \
+	\
+		for (prev = NULL, node = runs; node != NULL; prev = node, node = node->next) { \
+			node->prev = prev; \
+		} \
+		list->head = runs; \
+		list->tail = prev; \
+		return 0; \
+	} \
+	\
+	int \
+	name##_insert(name *list, name##Node *insertPos, T value, LlistDirection dir) { \
+		name##Node *node; \
+	\
+		assert(list != NULL); \
+		if (dir != LLIST_BEFORE && dir != LLIST_AFTER) { \
+			return -1; \
+		} \
+		node = malloc(sizeof (*node)); \
+		if (node == NULL) { \
+			return -2; \
+		} \
+		node->data = value; \
+	\
+		if (insertPos == NULL) { \
+			insertPos = (dir == LLIST_AFTER) ? list->tail : list->head; \
+		} \
+		if (dir == LLIST_AFTER) { \
+			node->prev = insertPos; \
+			node->next = (insertPos != NULL) ? insertPos->next : NULL; \
+		} else { \
+			node->next = insertPos; \
+			node->prev = (insertPos != NULL) ? insertPos->prev : NULL; \
+		} \
+	\
+		if (node->prev != NULL) { \
+			node->prev->next = node; \
+		} else { \
+			list->head = node; \
+		} \
+		if (node->next != NULL) { \
+			node->next->prev = node; \
+		} else { \
+			list->tail = node; \
+		} \
+		list->nbNodes++; \
+		return 0; \
+	} \
+	\
+	int \
+	name##_insertHead(name *list, T value) { \
+		return name##_insert(list, NULL, value, LLIST_BEFORE); \
+	} \
+	\
+	int \
+	name##_insertTail(name *list, T value) { \
+		return name##_insert(list, NULL, value, LLIST_AFTER); \
+	} \
+	\
+	int \
+	name##_pop(name *list, name##Node *node, T *p_value) { \
+		assert(list != NULL); \
+		if (node == NULL) { \
+			return -1; \
+		} \
+	\
+		if (node->prev != NULL) { \
+			node->prev->next = node->next; \
+		} else { \
+			list->head = node->next; \
+		} \
+		if (node->next != NULL) { \
+			node->next->prev = node->prev; \
+		} else { \
+			list->tail = node->prev; \
+		} \
+		list->nbNodes--; \
+	\
+		if (p_value != NULL) { \
+			*p_value = node->data; \
+		} \
+		free(node); \
+		return 0; \
+	} \
+	\
+	int \
+	name##_popHead(name *list, T *p_value) { \
+		assert(list != NULL); \
+		return name##_pop(list, list->head, p_value); \
+	} \
+	\
+	int \
+	name##_popTail(name *list, T *p_value) { \
+		assert(list != NULL); \
+		return name##_pop(list, list->tail, p_value); \
+	} \
+	\
+	int \
+	name##_popTail(name *list, T *p_value)
+
+#endif /* Guard */
@@ -0,0 +1,619 @@
+/*
+ * Unrolled variant of LinkedList, see UnrolledList.h
+ */
+
+#include <stdlib.h>
+#include <string.h> /* memmove, memcpy */
+#include <assert.h>
+
+#include "UnrolledList.h"
+
+
+/* As many data pointers as fit in a cache line along with the links and the count */
+#define ULLIST_NODE_SIZE 64
+#define ULLIST_SLOTS ((ULLIST_NODE_SIZE - 2 * sizeof (void *) - sizeof (size_t)) / sizeof (void *))
+
+
+struct UNode {
+	struct UNode *prev;
+	struct UNode *next;
+	size_t count;
+	void *data[ULLIST_SLOTS];
+};
+
+
+struct s_UnrolledList {
+	struct UNode *head;
+	struct UNode *tail;
+	size_t nbData;
+	nodeDestroyFunc f_destroyNode;
+	nodeCmpFunc f_cmpNode;
+};
+
+
+/* node is NULL when the cursor doesn't point to anything */
+struct s_UllistCursor {
+	struct UNode *node;
+	size_t slot;
+};
+
+
+
+/* === Internal functions === */
+static int
+isUserPointerValid(UllistCursor *cursor) {
+	return (cursor != NULL && cursor->node != NULL);
+}
+
+
+static struct UNode *
+new_unode(void) {
+	struct UNode *node = malloc(sizeof (*node));
+
+	if (node != NULL) {
+		node->prev = node->next = NULL;
+		node->count = 0;
+	}
+
+	return node;
+}
+
+
+/* Links newNode next to node (node is NULL if the list is empty) */
+static void
+linkNode(UnrolledList *ullist, struct UNode *node, struct UNode *newNode, LlistDirection dir) {
+	if (node == NULL) {
+		assert(ullist->head == NULL && ullist->tail == NULL);
+		ullist->head = ullist->tail = newNode;
+
+	} else if (dir == LLIST_BEFORE) {
+		newNode->prev = node->prev;
+		newNode->next = node;
+		if (node->prev != NULL) {
+			node->prev->next = newNode;
+		} else {
+			ullist->head = newNode;
+		}
+		node->prev = newNode;
+
+	} else {
+		newNode->prev = node;
+		newNode->next = node->next;
+		if (node->next != NULL) {
+			node->next->prev = newNode;
+		} else {
+			ullist->tail = newNode;
+		}
+		node->next = newNode;
+	}
+}
+
+
+static void
+unlinkNode(UnrolledList *ullist, struct UNode *node) {
+	if (node->prev != NULL) {
+		node->prev->next = node->next;
+	} else {
+		ullist->head = node->next;
+	}
+
+	if (node->next != NULL) {
+		node->next->prev = node->prev;
+	} else {
+		ullist->tail = node->prev;
+	}
+
+	free(node);
+}
+
+
+/* Inserts data so that it ends up at slot in node (slot can be node->count to append)
+ * Splits node if it is full. If track is not NULL and points inside node, it is
+ * updated to keep pointing to the same data
+ */
+static int
+insertAt(UnrolledList *ullist, struct UNode *node, size_t slot, void *data, UllistCursor *track) {
+	if (node == NULL || node->count == ULLIST_SLOTS) {
+		struct UNode *newNode = new_unode();
+
+		if (newNode == NULL) {
+			return -1;
+		}
+
+		if (node == NULL) {
+			linkNode(ullist, NULL, newNode, LLIST_AFTER);
+			node = newNode;
+			slot = 0;
+
+		/* Appending to the tail or prepending to the head: start a new Node
+		 * rather than splitting, so queues keep full Nodes */
+		} else if (slot == node->count && node->next == NULL) {
+			linkNode(ullist, node, newNode, LLIST_AFTER);
+			node = newNode;
+			slot = 0;
+		} else if (slot == 0 && node->prev == NULL) {
+			linkNode(ullist, node, newNode, LLIST_BEFORE);
+			node = newNode;
+
+		/* Move the upper half to a new Node */
+		} else {
+			size_t keep = (ULLIST_SLOTS + 1) / 2;
+
+			newNode->count = node->count - keep;
+			memcpy(newNode->data, node->data + keep, newNode->count * sizeof (node->data[0]));
+			node->count = keep;
+			linkNode(ullist, node, newNode, LLIST_AFTER);
+
+			if (track != NULL && track->node == node && track->slot >= keep) {
+				track->node = newNode;
+				track->slot -= keep;
+			}
+
+			if (slot > keep) {
+				node = newNode;
+				slot -= keep;
+			}
+		}
+	}
+
+	assert(slot <= node->count && node->count < ULLIST_SLOTS);
+
+	memmove(node->data + slot + 1, node->data + slot, (node->count - slot) * sizeof (node->data[0]));
+	node->data[slot] = data;
+	node->count++;
+	ullist->nbData++;
+
+	if (track != NULL && track->node == node && track->slot >= slot) {
+		track->slot++;
+	}
+
+	return 0;
+}
+
+
+/* Removes the data at slot in node, merging underfull Nodes with a neighbour */
+static void *
+removeAt(UnrolledList *ullist, struct UNode *node, size_t slot) {
+	void *data;
+
+	assert(slot < node->count);
+
+	data = node->data[slot];
+	node->count--;
+	memmove(node->data + slot, node->data + slot + 1, (node->count - slot) * sizeof (node->data[0]));
+	ullist->nbData--;
+
+	if (node->count == 0) {
+		unlinkNode(ullist, node);
+
+	} else if (node->count < ULLIST_SLOTS / 2) {
+		struct UNode *next = node->next;
+		struct UNode *prev = node->prev;
+
+		if (next != NULL && node->count + next->count <= ULLIST_SLOTS) {
+			memcpy(node->data + node->count, next->data, next->count * sizeof (node->data[0]));
+			node->count += next->count;
+			unlinkNode(ullist, next);
+
+		} else if (prev != NULL && prev->count + node->count <= ULLIST_SLOTS) {
+			memcpy(prev->data + prev->count, node->data, node->count * sizeof (node->data[0]));
+			prev->count += node->count;
+			unlinkNode(ullist, node);
+		}
+	}
+
+	return data;
+}
+
+/* === END Internal functions === */
+
+
+
+UnrolledList *
+ullist_new(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode) {
+	UnrolledList *ullist = malloc(sizeof (*ullist));
+
+	if (ullist != NULL) {
+		ullist->head = NULL;
+		ullist->tail = NULL;
+		ullist->nbData = 0;
+
+		ullist->f_destroyNode = f_destroyNode;
+		ullist->f_cmpNode = f_cmpNode;
+	}
+
+	return ullist;
+}
+
+
+int
+ullist_destroy(UnrolledList **p_ullist) {
+	struct UNode *node;
+	int error = 0;
+
+	if (p_ullist == NULL || *p_ullist == NULL) {
+		return 0;
+	}
+
+	node = (*p_ullist)->head;
+	while (node != NULL) {
+		struct UNode *next = node->next;
+		size_t slot;
+
+		if ((*p_ullist)->f_destroyNode != NULL) {
+			for (slot = 0; slot < node->count; slot++) {
+				int destroyCode = (*p_ullist)->f_destroyNode(node->data[slot]);
+
+				if (destroyCode != 0) {
+					error = destroyCode;
+				}
+			}
+		}
+		free(node);
+		node = next;
+	}
+
+	free(*p_ullist), *p_ullist = NULL;
+	return error;
+}
+
+
+size_t
+ullist_size(UnrolledList *ullist) {
+	return ullist->nbData;
+}
+
+
+/* Returns 0 on success, negative number on failure */
+int
+ullist_insertHead(UnrolledList *ullist, void *data) {
+	return insertAt(ullist, ullist->head, 0, data, NULL);
+}
+
+
+/* Returns 0 on success, negative number on failure */
+int
+ullist_insertTail(UnrolledList *ullist, void *data) {
+	struct UNode *tail = ullist->tail;
+
+	return insertAt(ullist, tail, (tail != NULL) ? tail->count : 0, data, NULL);
+}
+
+
+/* Returns 0 on success, negative number on failure
+ * cursor keeps pointing to the same data
+ */
+int
+ullistCursor_insertData(UnrolledList *ullist, UllistCursor *cursor, void *data, LlistDirection dir) {
+	if (!isUserPointerValid(cursor)) {
+		return -2;
+	}
+
+	switch (dir) {
+	case LLIST_BEFORE:
+		return insertAt(ullist, cursor->node, cursor->slot, data, cursor);
+	case LLIST_AFTER:
+		return insertAt(ullist, cursor->node, cursor->slot + 1, data, cursor);
+	default:
+		return -3;
+	}
+}
+
+
+/* Caller is responsible of freeing the data returned */
+void *
+ullist_popNode(UnrolledList *ullist, UllistCursor *cursor) {
+	void *data;
+
+	if (!isUserPointerValid(cursor)) {
+		return NULL;
+	}
+
+	data = removeAt(ullist, cursor->node, cursor->slot);
+	cursor->node = NULL;
+	return data;
+}
+
+
+int
+ullist_removeNode(UnrolledList *ullist, UllistCursor *cursor) {
+	void *data;
+
+	if (!isUserPointerValid(cursor)) {
+		return -1;
+	}
+
+	data = ullist_popNode(ullist, cursor);
+	if (ullist->f_destroyNode != NULL) {
+		return ullist->f_destroyNode(data);
+	}
+	return 0;
+}
+
+
+/* Returns NULL in case of error (or if the list is empty)
+ * Caller is responsible of freeing data
+ */
+void *
+ullist_popHead(UnrolledList *ullist) {
+	if (ullist == NULL || ullist->head == NULL) {
+		return NULL;
+	}
+	return removeAt(ullist, ullist->head, 0);
+}
+
+
+/* Returns NULL in case of error (or if the list is empty)
+ * Caller is responsible of freeing data
+ */
+void *
+ullist_popTail(UnrolledList *ullist) {
+	if (ullist == NULL || ullist->tail == NULL) {
+		return NULL;
+	}
+	return removeAt(ullist, ullist->tail, ullist->tail->count - 1);
+}
+
+
+/*
+ * ullist_countMatch
+ *
+ * ullist: UnrolledList to search into
+ * data: data to match such that ullist->f_cmpNode(data, nodeData) == 0
+ */
+size_t
+ullist_countMatch(UnrolledList *ullist, void *data) {
+	struct UNode *node;
+	size_t count = 0;
+
+	for (node = ullist->head; node != NULL; node = node->next) {
+		size_t slot;
+
+		for (slot = 0; slot < node->count; slot++) {
+			if (0 == ullist->f_cmpNode(data, node->data[slot])) {
+				count++;
+			}
+		}
+	}
+
+	return count;
+}
+
+
+void *
+ullist_getHeadData(UnrolledList *ullist) {
+	return ullist->head->data[0];
+}
+
+
+void *
+ullist_getTailData(UnrolledList *ullist) {
+	return ullist->tail->data[ullist->tail->count - 1];
+}
+
+
+
+/* === Cursor functions === */
+UllistCursor *
+ullistCursor_new(void) {
+	UllistCursor *cursor = malloc(sizeof (*cursor));
+
+	if (cursor != NULL) {
+		cursor->node = NULL;
+		cursor->slot = 0;
+	}
+	return cursor;
+}
+
+
+UllistCursor *
+ullistCursor_copy(UllistCursor *cursor) {
+	UllistCursor *copy;
+
+	if (cursor == NULL) {
+		return NULL;
+	}
+
+	copy = ullistCursor_new();
+	if (copy != NULL) {
+		*copy = *cursor;
+	}
+	return copy;
+}
+
+
+int
+ullistCursor_destroy(UllistCursor **p_cursor) {
+	if (p_cursor != NULL) {
+		free(*p_cursor), *p_cursor = NULL;
+		return 0;
+	}
+	return -1;
+}
+
+
+int
+ullistCursor_setData(UnrolledList *ullist, UllistCursor *cursor, void *newData) {
+	(void)ullist;
+
+	if (!isUserPointerValid(cursor)) {
+		return -1;
+	}
+
+	cursor->node->data[cursor->slot] = newData;
+	return 0;
+}
+
+
+void *
+ullistCursor_getData(UnrolledList *ullist, UllistCursor *cursor) {
+	(void)ullist;
+
+	if (!isUserPointerValid(cursor)) {
+		return NULL;
+	}
+
+	return cursor->node->data[cursor->slot];
+}
+
+
+int
+ullistCursor_getHead(UnrolledList *ullist, UllistCursor *cursor) {
+	if (cursor == NULL) {
+		return -1;
+	}
+
+	cursor->node = ullist->head;
+	cursor->slot = 0;
+	return 0;
+}
+
+
+int
+ullistCursor_getTail(UnrolledList *ullist, UllistCursor *cursor) {
+	if (cursor == NULL) {
+		return -1;
+	}
+
+	cursor->node = ullist->tail;
+	cursor->slot = (ullist->tail != NULL) ? ullist->tail->count - 1 : 0;
+	return 0;
+}
+
+
+int
+ullistCursor_getPrev(UnrolledList *ullist, UllistCursor *cursor) {
+	(void)ullist;
+
+	if (!isUserPointerValid(cursor)) {
+		return -2;
+	}
+
+	if (cursor->slot > 0) {
+		cursor->slot--;
+	} else if (cursor->node->prev != NULL) {
+		cursor->node = cursor->node->prev;
+		cursor->slot = cursor->node->count - 1;
+	} else {
+		return -1;
+	}
+	return 0;
+}
+
+
+int
+ullistCursor_getNext(UnrolledList *ullist, UllistCursor *cursor) {
+	(void)ullist;
+
+	if (!isUserPointerValid(cursor)) {
+		return -2;
+	}
+
+	if (cursor->slot + 1 < cursor->node->count) {
+		cursor->slot++;
+	} else if (cursor->node->next != NULL) {
+		cursor->node = cursor->node->next;
+		cursor->slot = 0;
+	} else {
+		return -1;
+	}
+	return 0;
+}
+
+
+/* Same return values as llistCursor_isTail (0 when cursor is the tail) */
+int
+ullistCursor_isTail(UnrolledList *ullist, UllistCursor *cursor) {
+	(void)ullist;
+
+	if (!isUserPointerValid(cursor)) {
+		return -1;
+	}
+	return !(cursor->node->next == NULL && cursor->slot + 1 == cursor->node->count);
+}
+
+
+/* Same return values as llistCursor_isHead (0 when cursor is the head) */
+int
+ullistCursor_isHead(UnrolledList *ullist, UllistCursor *cursor) {
+	(void)ullist;
+
+	if (!isUserPointerValid(cursor)) {
+		return -1;
+	}
+	return !(cursor->node->prev == NULL && cursor->slot == 0);
+}
+
+
+int
+ullistCursor_findNext(UnrolledList *ullist, UllistCursor *cursor, void *data) {
+	if (ullistCursor_getNext(ullist, cursor) != 0) {
+		return -4;
+	}
+	return ullistCursor_find(ullist, cursor, data, LLIST_AFTER);
+}
+
+
+int
+ullistCursor_findPrev(UnrolledList *ullist, UllistCursor *cursor, void *data) {
+	if (ullistCursor_getPrev(ullist, cursor) != 0) {
+		return -4;
+	}
+	return ullistCursor_find(ullist, cursor, data, LLIST_BEFORE);
+}
+
+
+/*
+ * ullistCursor_find
+ *
+ * Same as llistCursor_find: starts at (and includes) the data cursor points to
+ * and moves cursor to the first data such that ullist->f_cmpNode(data, nodeData) == 0
+ */
+int
+ullistCursor_find(UnrolledList *ullist, UllistCursor *cursor, void *data, LlistDirection searchDir) {
+	struct UNode *node;
+	size_t slot;
+
+	if (!isUserPointerValid(cursor)) {
+		return -2;
+	}
+
+	node = cursor->node;
+	slot = cursor->slot;
+
+	switch (searchDir) {
+	case LLIST_BEFORE:
+		while (node != NULL) {
+			slot++;
+			while (slot-- > 0) {
+				if (0 == ullist->f_cmpNode(data, node->data[slot])) {
+					cursor->node = node;
+					cursor->slot = slot;
+					return 0;
+				}
+			}
+
+			node = node->prev;
+			if (node != NULL) {
+				slot = node->count - 1;
+			}
+		}
+		break;
+	case LLIST_AFTER:
+		for (; node != NULL; node = node->next, slot = 0) {
+			for (; slot < node->count; slot++) {
+				if (0 == ullist->f_cmpNode(data, node->data[slot])) {
+					cursor->node = node;
+					cursor->slot = slot;
+					return 0;
+				}
+			}
+		}
+		break;
+	default:
+		return -3;
+	}
+
+	return -1;
+}
+/* === END Cursor functions === */
@@ -0,0 +1,132 @@
+/*
+ * Unrolled variant of LinkedList: each Node holds a small array of data pointers
+ * (sized so a whole Node fits in a 64 bytes cache line) instead of a single one.
+ *
+ * The API mirrors LinkedList's, with one difference for cursors: inserting or
+ * removing data moves the other data of the same Node around, so it invalidates
+ * every cursor except the one passed to the call (which stays on its data for
+ * llistCursor_insertData and is invalidated by ullist_popNode/ullist_removeNode,
+ * same as LinkedList)
+ */
+
+#ifndef UNROLLED_LIST_H
+#define UNROLLED_LIST_H
+
+#include <stdlib.h> /* size_t */
+
+#include "LinkedList.h" /* LlistDirection, nodeDestroyFunc, nodeCmpFunc */
+
+
+/* Forward declare and typedef internal structs (since callers shouldn't know the internals) */
+typedef struct s_UllistCursor UllistCursor;
+typedef struct s_UnrolledList UnrolledList;
+
+
+
+/* === ctor/dtor === */
+
+UnrolledList *
+ullist_new(nodeDestroyFunc f_destroyNode, nodeCmpFunc f_cmpNode);
+
+
+int
+ullist_destroy(UnrolledList **p_ullist);
+
+/* === END ctor/dtor === */
+
+
+
+/* === cursor functions === */
+
+UllistCursor *
+ullistCursor_new(void);
+
+UllistCursor *
+ullistCursor_copy(UllistCursor *cursor);
+
+int
+ullistCursor_destroy(UllistCursor **p_cursor);
+
+int
+ullistCursor_setData(UnrolledList *ullist, UllistCursor *cursor, void *newData);
+
+void *
+ullistCursor_getData(UnrolledList *ullist, UllistCursor *cursor);
+
+int
+ullistCursor_getNext(UnrolledList *ullist, UllistCursor *cursor);
+
+int
+ullistCursor_getPrev(UnrolledList *ullist, UllistCursor *cursor);
+
+int
+ullistCursor_findNext(UnrolledList *ullist, UllistCursor *cursor, void *data);
+
+int
+ullistCursor_findPrev(UnrolledList *ullist, UllistCursor *cursor, void *data);
+
+int
+ullistCursor_find(UnrolledList *ullist, UllistCursor *cursor, void *data, LlistDirection searchDir);
+
+int
+ullistCursor_getHead(UnrolledList *ullist, UllistCursor *cursor);
+
+int
+ullistCursor_getTail(UnrolledList *ullist, UllistCursor *cursor);
+
+int
+ullistCursor_isTail(UnrolledList *ullist, UllistCursor *cursor);
+
+int
+ullistCursor_isHead(UnrolledList *ullist, UllistCursor *cursor);
+
+int
+ullistCursor_insertData(UnrolledList *ullist, UllistCursor *cursor, void *data, LlistDirection dir);
+
+/* === END cursor functions === */
+
+
+
+/* === Query functions === */
+
+size_t
+ullist_size(UnrolledList *ullist);
+
+size_t
+ullist_countMatch(UnrolledList *ullist, void *data);
+
+void *
+ullist_getHeadData(UnrolledList *ullist);
+
+void *
+ullist_getTailData(UnrolledList *ullist);
+
+/* === END Query functions === */
+
+
+/* === Insert functions === */
+int
+ullist_insertHead(UnrolledList *ullist, void *data);
+
+int
+ullist_insertTail(UnrolledList *ullist, void *data);
+
+/* === END Insert functions === */
+
+
+/* === Delete functions === */
+void *
+ullist_popNode(UnrolledList *ullist, UllistCursor *cursor);
+
+int
+ullist_removeNode(UnrolledList *ullist, UllistCursor *cursor);
+
+void *
+ullist_popHead(UnrolledList *ullist);
+
+void *
+ullist_popTail(UnrolledList *ullist);
+
+/* === END Delete functions === */
+
+#endif /* Guard */
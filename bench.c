@@ -0,0 +1,298 @@
+/*
+ * Benchmark driver: times the main list operations over sizes from 10 up to
+ * 10^7 Nodes, with keys inserted in random or already sorted order, and prints
+ * one CSV (default) or JSON line per measurement so runs from different
+ * commits can be compared.
+ *
+ * ns_per_op is per Node for insertions, pops, sorts and destroying, and per
+ * query for llistCursor_find and llist_countMatch. allocs_per_op counts the
+ * calls to the list's allocator. rss_kb is the resident memory right after
+ * the measurement.
+ *
+ * Usage: ./bench [--json] [--max nbNodes]
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "LinkedList.h"
+
+
+/* Small sizes are repeated until about that many Nodes went through */
+#define BENCH_MIN_NODES 1000000L
+
+/* Queries get about that many Node visits in total */
+#define BENCH_QUERY_VISITS 100000000.0
+
+
+typedef struct {
+	long nbAllocs;
+} AllocStats;
+
+
+static int b_json = 0;
+static int b_firstJson = 1;
+
+
+static void *
+countingAlloc(void *context, size_t size) {
+	((AllocStats *)context)->nbAllocs++;
+	return malloc(size);
+}
+
+
+static void
+countingFree(void *context, void *ptr) {
+	(void)context;
+	free(ptr);
+}
+
+
+static int
+cmpInt(void *a, void *b) {
+	int x = *((int *)a);
+	int y = *((int *)b);
+
+	return (x > y) - (x < y);
+}
+
+
+static unsigned long
+intKey(void *data) {
+	/* Flips the sign bit so that keys order like the ints */
+	return (unsigned long)(*((int *)data)) ^ (1UL << (8 * sizeof (int) - 1));
+}
+
+
+static double
+nowNs(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+
+static long
+rssKb(void) {
+	FILE *statm = fopen("/proc/self/statm", "r");
+	long pages = 0, resident = 0;
+
+	if (statm == NULL) {
+		return 0;
+	}
+	if (fscanf(statm, "%ld %ld", &pages, &resident) != 2) {
+		resident = 0;
+	}
+	fclose(statm);
+
+	return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+
+static void
+report(const char *benchmark, long nbNodes, const char *order, double ns, double nbOps, long nbAllocs) {
+	double nsPerOp = (nbOps > 0) ? ns / nbOps : 0;
+	double allocsPerOp = (nbOps > 0) ? nbAllocs / nbOps : 0;
+
+	if (b_json) {
+		printf("%s\n  {\"benchmark\": \"%s\", \"size\": %ld, \"order\": \"%s\", "
+				"\"ns_per_op\": %.2f, \"allocs_per_op\": %.3f, \"rss_kb\": %ld}",
+				b_firstJson ? "[" : ",", benchmark, nbNodes, order, nsPerOp, allocsPerOp, rssKb());
+		b_firstJson = 0;
+	} else {
+		printf("%s,%ld,%s,%.2f,%.3f,%ld\n", benchmark, nbNodes, order, nsPerOp, allocsPerOp, rssKb());
+	}
+	fflush(stdout);
+}
+
+
+static LinkedList *
+newList(AllocStats *stats) {
+	LlistAllocator allocator;
+
+	allocator.f_alloc = countingAlloc;
+	allocator.f_free = countingFree;
+	allocator.context = stats;
+
+	return llist_newWithAllocator(NULL, cmpInt, &allocator);
+}
+
+
+static LinkedList *
+buildList(AllocStats *stats, int *keys, long nbNodes) {
+	LinkedList *llist = newList(stats);
+	long i;
+
+	for (i = 0; i < nbNodes; i++) {
+		llist_insertTail(llist, &keys[i]);
+	}
+	return llist;
+}
+
+
+/* Insertions at both ends, pops, sorting and destroying */
+static void
+benchUpdates(int *keys, long nbNodes, const char *order) {
+	long nbReps = (BENCH_MIN_NODES / nbNodes > 0) ? BENCH_MIN_NODES / nbNodes : 1;
+	double nsTail = 0, nsHead = 0, nsPop = 0, nsSort = 0, nsKeySort = 0, nsDestroy = 0;
+	long allocsTail = 0, allocsHead = 0, allocsPop = 0, allocsSort = 0, allocsKeySort = 0, allocsDestroy = 0;
+	long rep, i;
+
+	for (rep = 0; rep < nbReps; rep++) {
+		AllocStats stats = { 0 };
+		LinkedList *llist = newList(&stats);
+		double start;
+		long before;
+
+		before = stats.nbAllocs, start = nowNs();
+		for (i = 0; i < nbNodes; i++) {
+			llist_insertTail(llist, &keys[i]);
+		}
+		nsTail += nowNs() - start, allocsTail += stats.nbAllocs - before;
+
+		before = stats.nbAllocs, start = nowNs();
+		while (llist_popHead(llist) != NULL) {
+		}
+		nsPop += nowNs() - start, allocsPop += stats.nbAllocs - before;
+
+		before = stats.nbAllocs, start = nowNs();
+		for (i = 0; i < nbNodes; i++) {
+			llist_insertHead(llist, &keys[i]);
+		}
+		nsHead += nowNs() - start, allocsHead += stats.nbAllocs - before;
+
+		/* Both sorts get the keys in their given order, as built by buildList */
+		llist_destroy(&llist);
+		llist = buildList(&stats, keys, nbNodes);
+		before = stats.nbAllocs, start = nowNs();
+		llist_mergeSort(llist);
+		nsSort += nowNs() - start, allocsSort += stats.nbAllocs - before;
+
+		before = stats.nbAllocs, start = nowNs();
+		llist_destroy(&llist);
+		nsDestroy += nowNs() - start, allocsDestroy += stats.nbAllocs - before;
+
+		llist = buildList(&stats, keys, nbNodes);
+		before = stats.nbAllocs, start = nowNs();
+		llist_sortByKey(llist, intKey);
+		nsKeySort += nowNs() - start, allocsKeySort += stats.nbAllocs - before;
+		llist_destroy(&llist);
+	}
+
+	report("insertTail", nbNodes, order, nsTail, (double)nbNodes * nbReps, allocsTail);
+	report("insertHead", nbNodes, order, nsHead, (double)nbNodes * nbReps, allocsHead);
+	report("popHead", nbNodes, order, nsPop, (double)nbNodes * nbReps, allocsPop);
+	report("mergeSort", nbNodes, order, nsSort, (double)nbNodes * nbReps, allocsSort);
+	report("sortByKey", nbNodes, order, nsKeySort, (double)nbNodes * nbReps, allocsKeySort);
+	report("destroy", nbNodes, order, nsDestroy, (double)nbNodes * nbReps, allocsDestroy);
+}
+
+
+/* Lookups of keys picked all over the list */
+static void
+benchQueries(int *keys, long nbNodes, const char *order) {
+	long nbQueries = (long)(BENCH_QUERY_VISITS / nbNodes);
+	AllocStats stats = { 0 };
+	LinkedList *llist;
+	LlistCursor *cursor = llistCursor_new();
+	double start, nsFind, nsCount;
+	long before, allocsFind, allocsCount, i;
+	unsigned long rand = 1;
+	size_t total = 0;
+
+	if (nbQueries < 1) {
+		nbQueries = 1;
+	}
+	llist = buildList(&stats, keys, nbNodes);
+
+	before = stats.nbAllocs, start = nowNs();
+	for (i = 0; i < nbQueries; i++) {
+		rand = rand * 1103515245 + 12345;
+		llistCursor_getHead(llist, cursor);
+		total += llistCursor_find(llist, cursor, &keys[(rand >> 8) % nbNodes], LLIST_AFTER);
+	}
+	nsFind = nowNs() - start, allocsFind = stats.nbAllocs - before;
+
+	before = stats.nbAllocs, start = nowNs();
+	for (i = 0; i < nbQueries; i++) {
+		rand = rand * 1103515245 + 12345;
+		total += llist_countMatch(llist, &keys[(rand >> 8) % nbNodes]);
+	}
+	nsCount = nowNs() - start, allocsCount = stats.nbAllocs - before;
+
+	/* Keeps the queries from being optimized out */
+	if (total == (size_t)-1) {
+		fprintf(stderr, "unlikely\n");
+	}
+
+	report("find", nbNodes, order, nsFind, (double)nbQueries, allocsFind);
+	report("countMatch", nbNodes, order, nsCount, (double)nbQueries, allocsCount);
+
+	llistCursor_destroy(&cursor);
+	llist_destroy(&llist);
+}
+
+
+int
+main(int argc, char *argv[]) {
+	long maxNodes = 10000000L;
+	long nbNodes;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--json") == 0) {
+			b_json = 1;
+		} else if (strcmp(argv[i], "--max") == 0 && i + 1 < argc) {
+			maxNodes = atol(argv[++i]);
+		} else {
+			fprintf(stderr, "Usage: %s [--json] [--max nbNodes]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!b_json) {
+		printf("benchmark,size,order,ns_per_op,allocs_per_op,rss_kb\n");
+	}
+
+	for (nbNodes = 10; nbNodes <= maxNodes; nbNodes *= 10) {
+		int *keys = malloc(nbNodes * sizeof (*keys));
+		unsigned long rand = 12345;
+		long j;
+
+		if (keys == NULL) {
+			return EXIT_FAILURE;
+		}
+
+		for (j = 0; j < nbNodes; j++) {
+			keys[j] = (int)j;
+		}
+		benchUpdates(keys, nbNodes, "sorted");
+		benchQueries(keys, nbNodes, "sorted");
+
+		/* Fisher-Yates */
+		for (j = nbNodes - 1; j > 0; j--) {
+			long k;
+			int tmp;
+
+			rand = rand * 1103515245 + 12345;
+			k = (long)((rand >> 8) % (unsigned long)(j + 1));
+			tmp = keys[j], keys[j] = keys[k], keys[k] = tmp;
+		}
+		benchUpdates(keys, nbNodes, "random");
+		benchQueries(keys, nbNodes, "random");
+
+		free(keys);
+	}
+
+	if (b_json) {
+		printf("%s\n]\n", b_firstJson ? "[" : "");
+	}
+
+	return EXIT_SUCCESS;
+}
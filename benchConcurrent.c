@@ -0,0 +1,172 @@
+/*
+ * Throughput of a LinkedList guarded by one mutex against ConcurrentList when
+ * threads walk the list and insert/remove in the middle of it. Each thread works
+ * in its own region of the list: it walks a few Nodes from its anchor, inserts
+ * after the Node it reached and removes what it inserted.
+ *
+ * Usage: ./benchConcurrent [maxThreads [opsPerThread]]
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "LinkedList.h"
+#include "ConcurrentList.h"
+
+
+#define REGION_NODES 1000
+#define WALK_STEPS 8
+
+
+typedef struct {
+	LinkedList *llist;
+	pthread_mutex_t *lock;
+	LlistCursor *llistAnchor;
+
+	ConcurrentList *clist;
+	ClistCursor *clistAnchor;
+
+	long nbOps;
+} Worker;
+
+
+static int dummy;
+
+
+static void *
+runLocked(void *arg) {
+	Worker *worker = arg;
+	long i;
+
+	for (i = 0; i < worker->nbOps; i++) {
+		LlistCursor *cursor = llistCursor_copy(worker->llistAnchor);
+		int step;
+
+		pthread_mutex_lock(worker->lock);
+		for (step = 0; step < WALK_STEPS; step++) {
+			llistCursor_getNext(worker->llist, cursor);
+		}
+		llistCursor_insertData(worker->llist, cursor, &dummy, LLIST_AFTER);
+		llistCursor_getNext(worker->llist, cursor);
+		llist_removeNode(worker->llist, cursor);
+		pthread_mutex_unlock(worker->lock);
+
+		llistCursor_destroy(&cursor);
+	}
+
+	return NULL;
+}
+
+
+static void *
+runPerNode(void *arg) {
+	Worker *worker = arg;
+	long i;
+
+	for (i = 0; i < worker->nbOps; i++) {
+		ClistCursor *cursor = clistCursor_copy(worker->clistAnchor);
+		int step;
+
+		for (step = 0; step < WALK_STEPS; step++) {
+			clistCursor_getNext(worker->clist, cursor);
+		}
+		clistCursor_insertData(worker->clist, cursor, &dummy, LLIST_AFTER);
+		clistCursor_getNext(worker->clist, cursor);
+		clist_removeNode(worker->clist, cursor);
+
+		clistCursor_destroy(&cursor);
+	}
+
+	return NULL;
+}
+
+
+/* Returns the throughput in millions of operations per second */
+static double
+timeThreads(void *(*f_run)(void *), Worker *workers, int nbThreads) {
+	pthread_t *threads = malloc(nbThreads * sizeof (*threads));
+	struct timespec start, end;
+	double seconds;
+	int i;
+
+	if (threads == NULL) {
+		return 0;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < nbThreads; i++) {
+		pthread_create(&threads[i], NULL, f_run, &workers[i]);
+	}
+	for (i = 0; i < nbThreads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	free(threads);
+
+	seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	return (double)workers[0].nbOps * nbThreads / seconds / 1e6;
+}
+
+
+int
+main(int argc, char *argv[]) {
+	int maxThreads = (argc > 1) ? atoi(argv[1]) : 8;
+	long nbOps = (argc > 2) ? atol(argv[2]) : 200000;
+	LinkedList *llist = llist_new(NULL, NULL);
+	ConcurrentList *clist = clist_new(NULL, NULL);
+	pthread_mutex_t lock;
+	Worker *workers = malloc(maxThreads * sizeof (*workers));
+	int nbThreads;
+	long i;
+
+	if (llist == NULL || clist == NULL || workers == NULL || maxThreads < 1) {
+		return EXIT_FAILURE;
+	}
+	pthread_mutex_init(&lock, NULL);
+
+	for (i = 0; i < (long)maxThreads * REGION_NODES; i++) {
+		llist_insertTail(llist, &dummy);
+		clist_insertTail(clist, &dummy);
+	}
+
+	for (i = 0; i < maxThreads; i++) {
+		long step;
+
+		workers[i].llist = llist;
+		workers[i].lock = &lock;
+		workers[i].llistAnchor = llistCursor_new();
+		llistCursor_seek(llist, workers[i].llistAnchor, i * REGION_NODES);
+
+		workers[i].clist = clist;
+		workers[i].clistAnchor = clistCursor_new();
+		clistCursor_getHead(clist, workers[i].clistAnchor);
+		for (step = 0; step < i * REGION_NODES; step++) {
+			clistCursor_getNext(clist, workers[i].clistAnchor);
+		}
+
+		workers[i].nbOps = nbOps;
+	}
+
+	printf("threads  mutex+llist (Mops/s)  clist (Mops/s)\n");
+	for (nbThreads = 1; nbThreads <= maxThreads; nbThreads *= 2) {
+		double locked = timeThreads(runLocked, workers, nbThreads);
+		double perNode = timeThreads(runPerNode, workers, nbThreads);
+
+		printf("%7d  %20.2f  %14.2f\n", nbThreads, locked, perNode);
+	}
+
+	for (i = 0; i < maxThreads; i++) {
+		llistCursor_destroy(&(workers[i].llistAnchor));
+		clistCursor_destroy(&(workers[i].clistAnchor));
+	}
+	free(workers);
+	pthread_mutex_destroy(&lock);
+	clist_destroy(&clist);
+	llist_destroy(&llist);
+
+	return EXIT_SUCCESS;
+}
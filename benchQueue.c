@@ -0,0 +1,117 @@
+/*
+ * Throughput of a LinkedList guarded by one mutex against ConcurrentQueue when
+ * used as a work queue: every thread alternately enqueues and dequeues.
+ *
+ * Usage: ./benchQueue [maxThreads [opsPerThread]]
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "LinkedList.h"
+#include "ConcurrentQueue.h"
+
+
+typedef struct {
+	LinkedList *llist;
+	pthread_mutex_t lock;
+	ConcurrentQueue *queue;
+	long nbOps;
+} Shared;
+
+
+static int dummy;
+
+
+static void *
+runLocked(void *arg) {
+	Shared *shared = arg;
+	long i;
+
+	for (i = 0; i < shared->nbOps; i++) {
+		pthread_mutex_lock(&(shared->lock));
+		llist_insertTail(shared->llist, &dummy);
+		pthread_mutex_unlock(&(shared->lock));
+
+		pthread_mutex_lock(&(shared->lock));
+		llist_popHead(shared->llist);
+		pthread_mutex_unlock(&(shared->lock));
+	}
+
+	return NULL;
+}
+
+
+static void *
+runLockFree(void *arg) {
+	Shared *shared = arg;
+	long i;
+
+	for (i = 0; i < shared->nbOps; i++) {
+		cqueue_insertTail(shared->queue, &dummy);
+		cqueue_popHead(shared->queue);
+	}
+
+	return NULL;
+}
+
+
+/* Returns the throughput in millions of operations per second */
+static double
+timeThreads(void *(*f_run)(void *), Shared *shared, int nbThreads) {
+	pthread_t *threads = malloc(nbThreads * sizeof (*threads));
+	struct timespec start, end;
+	double seconds;
+	int i;
+
+	if (threads == NULL) {
+		return 0;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < nbThreads; i++) {
+		pthread_create(&threads[i], NULL, f_run, shared);
+	}
+	for (i = 0; i < nbThreads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	free(threads);
+
+	seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	return 2.0 * shared->nbOps * nbThreads / seconds / 1e6;
+}
+
+
+int
+main(int argc, char *argv[]) {
+	int maxThreads = (argc > 1) ? atoi(argv[1]) : 8;
+	Shared shared;
+	int nbThreads;
+
+	shared.nbOps = (argc > 2) ? atol(argv[2]) : 200000;
+	shared.llist = llist_new(NULL, NULL);
+	shared.queue = cqueue_new(NULL);
+	pthread_mutex_init(&(shared.lock), NULL);
+	if (shared.llist == NULL || shared.queue == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	printf("threads  mutex+llist (Mops/s)  cqueue (Mops/s)\n");
+	for (nbThreads = 1; nbThreads <= maxThreads; nbThreads *= 2) {
+		double locked = timeThreads(runLocked, &shared, nbThreads);
+		double lockFree = timeThreads(runLockFree, &shared, nbThreads);
+
+		printf("%7d  %20.2f  %15.2f\n", nbThreads, locked, lockFree);
+	}
+
+	pthread_mutex_destroy(&(shared.lock));
+	cqueue_destroy(&(shared.queue));
+	llist_destroy(&(shared.llist));
+
+	return EXIT_SUCCESS;
+}
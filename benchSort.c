@@ -0,0 +1,90 @@
+/*
+ * Speed-up of llist_parallelSort over llist_mergeSort on a list of random ints
+ *
+ * Usage: ./benchSort [maxThreads [nbNodes]]
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "LinkedList.h"
+
+
+static int
+cmpInt(void *a, void *b) {
+	int x = *((int *)a);
+	int y = *((int *)b);
+
+	return (x > y) - (x < y);
+}
+
+
+static LinkedList *
+newShuffled(int *data, long nbNodes) {
+	LinkedList *llist = llist_newPooled(NULL, cmpInt, 0);
+	unsigned long rand = 42;
+	long i;
+
+	if (llist == NULL) {
+		return NULL;
+	}
+	for (i = 0; i < nbNodes; i++) {
+		rand = rand * 1103515245 + 12345;
+		data[i] = (int)(rand >> 8);
+		llist_insertTail(llist, &data[i]);
+	}
+
+	return llist;
+}
+
+
+/* Returns the time taken to sort a fresh list, in seconds (0 threads: llist_mergeSort) */
+static double
+timeSort(int *data, long nbNodes, size_t nbThreads) {
+	LinkedList *llist = newShuffled(data, nbNodes);
+	struct timespec start, end;
+
+	if (llist == NULL) {
+		return 0;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (nbThreads == 0) {
+		llist_mergeSort(llist);
+	} else {
+		llist_parallelSort(llist, nbThreads);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	llist_destroy(&llist);
+
+	return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+
+int
+main(int argc, char *argv[]) {
+	size_t maxThreads = (argc > 1) ? (size_t)atol(argv[1]) : 8;
+	long nbNodes = (argc > 2) ? atol(argv[2]) : 4000000;
+	int *data = malloc(nbNodes * sizeof (*data));
+	double serial;
+	size_t nbThreads;
+
+	if (data == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	serial = timeSort(data, nbNodes, 0);
+	printf("%ld nodes, llist_mergeSort: %.3f s\n", nbNodes, serial);
+	printf("threads  llist_parallelSort (s)  speed-up\n");
+	for (nbThreads = 1; nbThreads <= maxThreads; nbThreads++) {
+		double parallel = timeSort(data, nbNodes, nbThreads);
+
+		printf("%7lu  %22.3f  %8.2fx\n", (unsigned long)nbThreads, parallel, serial / parallel);
+	}
+
+	free(data);
+	return EXIT_SUCCESS;
+}
@@ -1,8 +1,15 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "LinkedList.h"
+#include "UnrolledList.h"
+#include "IntrusiveList.h"
+#include "ConcurrentQueue.h"
+#include "ConcurrentList.h"
+#include "TypedList.h"
 
 
 int
@@ -22,6 +29,2367 @@ addInt(int dataArray[], size_t *p_index, int data) {
 }
 
 
+typedef struct {
+	int key;
+	int seq;
+} Pair;
+
+
+int
+cmpPair(void *a, void *b) {
+	return ((Pair *)a)->key - ((Pair *)b)->key;
+}
+
+
+void
+testMergeSort(void) {
+	Pair pairs[1000];
+	int i;
+	LinkedList *llist = llist_new(NULL, cmpPair);
+	LlistCursor *cursor = llistCursor_new();
+	Pair *prev = NULL;
+
+	/* Empty and single element lists */
+	assert(0 == llist_mergeSort(llist));
+	pairs[0].key = 0, pairs[0].seq = 0;
+	assert(0 == llist_insertTail(llist, &pairs[0]));
+	assert(0 == llist_mergeSort(llist));
+	assert(llist_getHeadData(llist) == &pairs[0] && llist_getTailData(llist) == &pairs[0]);
+	assert(llistCursor_getHead(llist, cursor) == 0);
+	assert(llist_popNode(llist, cursor) == &pairs[0]);
+
+	/* Lots of duplicate keys in a pseudo-random order to check stability */
+	for (i = 0; i < 1000; i++) {
+		pairs[i].key = (i * 7919) % 37;
+		pairs[i].seq = i;
+		assert(0 == llist_insertTail(llist, &pairs[i]));
+	}
+
+	assert(0 == llist_mergeSort(llist));
+	/* Sorting a sorted list must not change anything */
+	assert(0 == llist_mergeSort(llist));
+
+	assert(llistCursor_getHead(llist, cursor) == 0);
+	assert(llistCursor_isHead(llist, cursor) == 0);
+	i = 0;
+	do {
+		Pair *cur = llistCursor_getData(llist, cursor);
+
+		if (prev != NULL) {
+			assert(prev->key < cur->key || (prev->key == cur->key && prev->seq < cur->seq));
+		}
+		prev = cur;
+		i++;
+	} while (llistCursor_getNext(llist, cursor) == 0);
+	assert(i == 1000);
+	assert(llistCursor_isTail(llist, cursor) == 0);
+	assert(llist_getTailData(llist) == prev);
+
+	/* Walk it backwards to check the prev links */
+	do {
+		i--;
+	} while (llistCursor_getPrev(llist, cursor) == 0);
+	assert(i == 0);
+	assert(llistCursor_isHead(llist, cursor) == 0);
+
+	assert(llistCursor_destroy(&cursor) == 0);
+	assert(llist_destroy(&llist) == 0);
+}
+
+
+static int nbDestroyed = 0;
+
+
+int
+countDestroy(void *data) {
+	(void)data;
+	nbDestroyed++;
+	return 0;
+}
+
+
+void
+testPooled(void) {
+	int values[100];
+	int i;
+	LinkedList *llist = llist_newPooled(countDestroy, cmpFunc, 16);
+	LlistCursor *cursor = llistCursor_new();
+
+	assert(llist != NULL);
+	assert(llist_popHead(llist) == NULL && llist_popTail(llist) == NULL);
+
+	/* Chunks whose size doesn't fit in a size_t */
+	assert(llist_newPooled(NULL, cmpFunc, (size_t)-1) == NULL);
+	assert(llist_newPooled(NULL, cmpFunc, (size_t)-1 / 16 * 3) == NULL);
+
+	for (i = 0; i < 100; i++) {
+		values[i] = 99 - i;
+		assert(0 == llist_insertTail(llist, &values[i]));
+	}
+
+	/* Recycle some Nodes through the free list */
+	for (i = 0; i < 10; i++) {
+		assert(llist_popHead(llist) == &values[i]);
+		assert(llist_popTail(llist) == &values[99 - i]);
+	}
+	for (i = 0; i < 10; i++) {
+		assert(0 == llist_insertHead(llist, &values[i]));
+	}
+
+	assert(llistCursor_getHead(llist, cursor) == 0);
+	assert(0 == llistCursor_insertData(llist, cursor, &values[99], LLIST_AFTER));
+	assert(llistCursor_getNext(llist, cursor) == 0);
+	assert(llistCursor_getData(llist, cursor) == &values[99]);
+	assert(0 == llist_removeNode(llist, cursor));
+	assert(nbDestroyed == 1);
+
+	assert(0 == llist_mergeSort(llist));
+	assert(*((int *)llist_getHeadData(llist)) == 10);
+	assert(*((int *)llist_getTailData(llist)) == 99);
+
+	assert(llistCursor_destroy(&cursor) == 0);
+	assert(llist_destroy(&llist) == 0);
+	assert(nbDestroyed == 91);
+}
+
+
+typedef struct {
+	size_t nbAllocs;
+	size_t nbFrees;
+} AllocCounter;
+
+
+void *
+countingAlloc(void *context, size_t size) {
+	((AllocCounter *)context)->nbAllocs++;
+	return malloc(size);
+}
+
+
+void
+countingFree(void *context, void *ptr) {
+	((AllocCounter *)context)->nbFrees++;
+	free(ptr);
+}
+
+
+typedef struct {
+	char *base;
+	size_t used;
+	size_t size;
+} Arena;
+
+
+void *
+arenaAlloc(void *context, size_t size) {
+	Arena *arena = context;
+	void *p;
+
+	/* Keep everything pointer aligned */
+	size = (size + sizeof (void *) - 1) / sizeof (void *) * sizeof (void *);
+	if (arena->used + size > arena->size) {
+		return NULL;
+	}
+	p = arena->base + arena->used;
+	arena->used += size;
+	return p;
+}
+
+
+void
+testAllocator(void) {
+	int values[10];
+	int i;
+	AllocCounter counter = { 0, 0 };
+	LlistAllocator counting;
+	LlistAllocator arenaAllocator;
+	Arena arena;
+	void *arenaMem[512];
+	LinkedList *llist;
+	LlistCursor *cursor, *copy;
+
+	counting.f_alloc = countingAlloc;
+	counting.f_free = countingFree;
+	counting.context = &counter;
+
+	llist = llist_newWithAllocator(countDestroy, cmpFunc, &counting);
+	cursor = llistCursor_newWithAllocator(&counting);
+	for (i = 0; i < 10; i++) {
+		values[i] = i;
+		assert(0 == llist_insertTail(llist, &values[i]));
+	}
+	assert(counter.nbAllocs == 12);
+
+	assert(llistCursor_getTail(llist, cursor) == 0);
+	copy = llistCursor_copy(cursor);
+	assert(copy != NULL && counter.nbAllocs == 13);
+	assert(llistCursor_getData(llist, copy) == &values[9]);
+	assert(llistCursor_destroy(&copy) == 0 && copy == NULL);
+
+	assert(llist_popTail(llist) == &values[9]);
+	assert(counter.nbFrees == 2);
+
+	nbDestroyed = 0;
+	assert(llistCursor_destroy(&cursor) == 0);
+	assert(llist_destroy(&llist) == 0);
+	assert(nbDestroyed == 9);
+	assert(counter.nbAllocs == counter.nbFrees);
+
+	/* No-op free: the whole list goes away with the arena */
+	arena.base = (char *)arenaMem;
+	arena.used = 0;
+	arena.size = sizeof (arenaMem);
+	arenaAllocator.f_alloc = arenaAlloc;
+	arenaAllocator.f_free = NULL;
+	arenaAllocator.context = &arena;
+
+	llist = llist_newWithAllocator(NULL, cmpFunc, &arenaAllocator);
+	for (i = 0; i < 10; i++) {
+		assert(0 == llist_insertHead(llist, &values[i]));
+	}
+	assert(llist_popHead(llist) == &values[9]);
+	assert(0 == llist_mergeSort(llist));
+	assert(llist_getHeadData(llist) == &values[0]);
+	assert(llist_destroy(&llist) == 0 && llist == NULL);
+}
+
+
+void
+testSizeAndSeek(void) {
+	int values[200];
+	int *expected[200];
+	size_t nbExpected = 0;
+	size_t i, step;
+	unsigned long rand = 12345;
+	LinkedList *llist = llist_new(NULL, cmpFunc);
+	LlistCursor *cursor = llistCursor_new();
+
+	assert(llist_size(llist) == 0);
+	assert(llistCursor_seek(llist, cursor, 0) == -1);
+	assert(llistCursor_seek(llist, NULL, 0) == -2);
+
+	for (i = 0; i < 200; i++) {
+		values[i] = (int)i;
+	}
+
+	/* Mix inserts and removals everywhere with seeks, checking against an array */
+	for (step = 0; step < 2000; step++) {
+		size_t pos;
+		int op;
+
+		rand = rand * 1103515245 + 12345;
+		op = (int)((rand >> 16) % 6);
+		pos = (nbExpected > 0) ? (rand >> 8) % nbExpected : 0;
+
+		if (nbExpected == 0 || (op < 3 && nbExpected < 200)) {
+			int *data = &values[step % 200];
+
+			if (nbExpected == 0 || op == 0) {
+				assert(0 == llist_insertHead(llist, data));
+				pos = 0;
+			} else if (op == 1) {
+				assert(0 == llist_insertTail(llist, data));
+				pos = nbExpected;
+			} else {
+				assert(0 == llistCursor_seek(llist, cursor, pos));
+				assert(0 == llistCursor_insertData(llist, cursor, data, (pos % 2) ? LLIST_BEFORE : LLIST_AFTER));
+				pos += (pos % 2) ? 0 : 1;
+			}
+			memmove(expected + pos + 1, expected + pos, (nbExpected - pos) * sizeof (*expected));
+			expected[pos] = data;
+			nbExpected++;
+
+		} else if (op == 3) {
+			assert(llist_popHead(llist) == expected[0]);
+			pos = 0;
+			memmove(expected, expected + 1, --nbExpected * sizeof (*expected));
+		} else if (op == 4) {
+			assert(llist_popTail(llist) == expected[--nbExpected]);
+		} else {
+			assert(0 == llistCursor_seek(llist, cursor, pos));
+			assert(llist_popNode(llist, cursor) == expected[pos]);
+			memmove(expected + pos, expected + pos + 1, (--nbExpected - pos) * sizeof (*expected));
+		}
+
+		assert(llist_size(llist) == nbExpected);
+
+		/* Nearby seeks then a few far away ones */
+		for (i = (pos > 2) ? pos - 2 : 0; i < nbExpected && i < pos + 3; i++) {
+			assert(0 == llistCursor_seek(llist, cursor, i));
+			assert(llistCursor_getData(llist, cursor) == expected[i]);
+		}
+		if (nbExpected > 0) {
+			assert(0 == llistCursor_seek(llist, cursor, nbExpected / 3));
+			assert(llistCursor_getData(llist, cursor) == expected[nbExpected / 3]);
+			assert(0 == llistCursor_seek(llist, cursor, nbExpected - 1));
+			assert(llistCursor_getData(llist, cursor) == expected[nbExpected - 1]);
+		}
+		assert(llistCursor_seek(llist, cursor, nbExpected) == -1);
+	}
+
+	/* Sorting moves Nodes around, seeks must not use a stale position */
+	assert(0 == llist_mergeSort(llist));
+	for (i = 1; i < nbExpected; i++) {
+		int prev;
+
+		assert(0 == llistCursor_seek(llist, cursor, i - 1));
+		prev = *(int *)llistCursor_getData(llist, cursor);
+		assert(0 == llistCursor_seek(llist, cursor, i));
+		assert(prev <= *(int *)llistCursor_getData(llist, cursor));
+	}
+
+	assert(llistCursor_destroy(&cursor) == 0);
+	assert(llist_destroy(&llist) == 0);
+}
+
+
+static void
+checkUnrolled(UnrolledList *ullist, int **expected, size_t nbExpected) {
+	UllistCursor *cursor = ullistCursor_new();
+	size_t i;
+
+	assert(ullist_size(ullist) == nbExpected);
+	assert(ullistCursor_getHead(ullist, cursor) == 0);
+	for (i = 0; i < nbExpected; i++) {
+		assert(ullistCursor_getData(ullist, cursor) == expected[i]);
+		assert(ullistCursor_isTail(ullist, cursor) == (i + 1 != nbExpected));
+		assert(ullistCursor_getNext(ullist, cursor) == ((i + 1 < nbExpected) ? 0 : -1));
+	}
+	for (i = nbExpected; i-- > 0; ) {
+		assert(ullistCursor_getData(ullist, cursor) == expected[i]);
+		assert(ullistCursor_isHead(ullist, cursor) == (i != 0));
+		assert(ullistCursor_getPrev(ullist, cursor) == ((i > 0) ? 0 : -1));
+	}
+	assert(ullistCursor_destroy(&cursor) == 0);
+}
+
+
+void
+testUnrolled(void) {
+	int values[300];
+	int *expected[300];
+	size_t nbExpected = 0;
+	size_t i, step;
+	unsigned long rand = 42;
+	UnrolledList *ullist = ullist_new(countDestroy, cmpFunc);
+	UllistCursor *cursor = ullistCursor_new();
+
+	assert(ullist_popHead(ullist) == NULL && ullist_popTail(ullist) == NULL);
+	assert(ullistCursor_getHead(ullist, cursor) == 0);
+	assert(ullistCursor_getNext(ullist, cursor) == -2);
+
+	for (i = 0; i < 300; i++) {
+		values[i] = (int)(i % 50);
+	}
+
+	for (step = 0; step < 3000; step++) {
+		size_t pos;
+		int op;
+
+		rand = rand * 1103515245 + 12345;
+		op = (int)((rand >> 16) % 6);
+		pos = (nbExpected > 0) ? (rand >> 8) % nbExpected : 0;
+
+		if (nbExpected == 0 || (op < 3 && nbExpected < 300)) {
+			int *data = &values[step % 300];
+
+			if (nbExpected == 0 || op == 0) {
+				assert(0 == ullist_insertHead(ullist, data));
+				pos = 0;
+			} else if (op == 1) {
+				assert(0 == ullist_insertTail(ullist, data));
+				pos = nbExpected;
+			} else {
+				assert(ullistCursor_getHead(ullist, cursor) == 0);
+				for (i = 0; i < pos; i++) {
+					assert(ullistCursor_getNext(ullist, cursor) == 0);
+				}
+				assert(0 == ullistCursor_insertData(ullist, cursor, data, (pos % 2) ? LLIST_BEFORE : LLIST_AFTER));
+				/* The cursor stays on its data even if its Node was split */
+				assert(ullistCursor_getData(ullist, cursor) == expected[pos]);
+				pos += (pos % 2) ? 0 : 1;
+			}
+			memmove(expected + pos + 1, expected + pos, (nbExpected - pos) * sizeof (*expected));
+			expected[pos] = data;
+			nbExpected++;
+
+		} else if (op == 3) {
+			assert(ullist_popHead(ullist) == expected[0]);
+			memmove(expected, expected + 1, --nbExpected * sizeof (*expected));
+		} else if (op == 4) {
+			assert(ullist_popTail(ullist) == expected[--nbExpected]);
+		} else {
+			assert(ullistCursor_getTail(ullist, cursor) == 0);
+			for (i = nbExpected - 1; i > pos; i--) {
+				assert(ullistCursor_getPrev(ullist, cursor) == 0);
+			}
+			assert(ullist_popNode(ullist, cursor) == expected[pos]);
+			assert(ullistCursor_getData(ullist, cursor) == NULL);
+			memmove(expected + pos, expected + pos + 1, (--nbExpected - pos) * sizeof (*expected));
+		}
+
+		checkUnrolled(ullist, expected, nbExpected);
+	}
+
+	/* Find and count against the reference */
+	{
+		int needle = *expected[nbExpected / 2];
+		size_t count = 0, firstPos = nbExpected, lastPos = nbExpected;
+
+		for (i = 0; i < nbExpected; i++) {
+			if (*expected[i] == needle) {
+				count++;
+				lastPos = i;
+				if (firstPos == nbExpected) {
+					firstPos = i;
+				}
+			}
+		}
+		assert(ullist_countMatch(ullist, &needle) == count);
+
+		assert(ullistCursor_getHead(ullist, cursor) == 0);
+		assert(ullistCursor_find(ullist, cursor, &needle, LLIST_AFTER) == 0);
+		assert(ullistCursor_getData(ullist, cursor) == expected[firstPos]);
+		assert(ullistCursor_getTail(ullist, cursor) == 0);
+		assert(ullistCursor_find(ullist, cursor, &needle, LLIST_BEFORE) == 0);
+		assert(ullistCursor_getData(ullist, cursor) == expected[lastPos]);
+		assert(ullistCursor_findNext(ullist, cursor, &needle) == ((lastPos + 1 < nbExpected) ? -1 : -4));
+
+		needle = 1000;
+		assert(ullistCursor_getHead(ullist, cursor) == 0);
+		assert(ullistCursor_find(ullist, cursor, &needle, LLIST_AFTER) == -1);
+	}
+
+	nbDestroyed = 0;
+	assert(ullistCursor_getHead(ullist, cursor) == 0);
+	assert(ullist_removeNode(ullist, cursor) == 0);
+	assert(nbDestroyed == 1);
+
+	assert(ullistCursor_destroy(&cursor) == 0);
+	assert(ullist_destroy(&ullist) == 0);
+	assert(nbDestroyed == (int)nbExpected);
+}
+
+
+typedef struct {
+	int key;
+	LlistHook hook;
+	int seq;
+} Item;
+
+
+int
+cmpItem(LlistHook *a, LlistHook *b) {
+	return LLIST_CONTAINER_OF(a, Item, hook)->key - LLIST_CONTAINER_OF(b, Item, hook)->key;
+}
+
+
+int
+countDestroyHook(LlistHook *hook) {
+	(void)hook;
+	nbDestroyed++;
+	return 0;
+}
+
+
+void
+testIntrusive(void) {
+	Item items[500];
+	Item probe;
+	LlistHook *hook;
+	Item *prev = NULL;
+	int i;
+	IntrusiveList *ilist = ilist_new(countDestroyHook, cmpItem);
+
+	assert(ilist_popHead(ilist) == NULL && ilist_popTail(ilist) == NULL);
+
+	for (i = 0; i < 500; i++) {
+		items[i].key = (i * 31) % 17;
+		items[i].seq = i;
+		assert(0 == ((i % 2) ? ilist_insertTail(ilist, &items[i].hook) : ilist_insertHead(ilist, &items[i].hook)));
+	}
+	assert(ilist_size(ilist) == 500);
+
+	assert(LLIST_CONTAINER_OF(ilist_popHead(ilist), Item, hook) == &items[498]);
+	assert(LLIST_CONTAINER_OF(ilist_popTail(ilist), Item, hook) == &items[499]);
+	assert(0 == ilist_pop(ilist, &items[250].hook));
+	assert(0 == ilist_insert(ilist, &items[0].hook, &items[250].hook, LLIST_AFTER));
+	assert(items[0].hook.next == &items[250].hook && items[250].hook.prev == &items[0].hook);
+	assert(ilist_size(ilist) == 498);
+
+	probe.key = 3;
+	assert(ilist_countMatch(ilist, &probe.hook) == 29);
+	hook = ilist_find(ilist, ilist_getHead(ilist), &probe.hook, LLIST_AFTER);
+	assert(hook != NULL && LLIST_CONTAINER_OF(hook, Item, hook)->key == 3);
+	hook = ilist_find(ilist, ilist_getTail(ilist), &probe.hook, LLIST_BEFORE);
+	assert(hook != NULL && LLIST_CONTAINER_OF(hook, Item, hook)->key == 3);
+	probe.key = 17;
+	assert(ilist_find(ilist, ilist_getHead(ilist), &probe.hook, LLIST_AFTER) == NULL);
+
+	/* Re-insert everything in seq order then sort, equal keys must stay in seq order */
+	while (ilist_popHead(ilist) != NULL) {
+	}
+	for (i = 0; i < 500; i++) {
+		assert(0 == ilist_insertTail(ilist, &items[i].hook));
+	}
+	assert(0 == ilist_mergeSort(ilist));
+	assert(ilist_getHead(ilist)->prev == NULL && ilist_getTail(ilist)->next == NULL);
+	for (i = 0, hook = ilist_getHead(ilist); hook != NULL; hook = hook->next, i++) {
+		Item *cur = LLIST_CONTAINER_OF(hook, Item, hook);
+
+		assert(hook->next == NULL || hook->next->prev == hook);
+		if (prev != NULL) {
+			assert(prev->key < cur->key || (prev->key == cur->key && prev->seq < cur->seq));
+		}
+		prev = cur;
+	}
+	assert(i == 500 && ilist_getTail(ilist) == &prev->hook);
+
+	nbDestroyed = 0;
+	assert(ilist_destroy(&ilist) == 0 && ilist == NULL);
+	assert(nbDestroyed == 500);
+}
+
+
+/* Checks llist holds exactly values (walking both ways), values ends with -1 */
+static void
+checkInts(LinkedList *llist, const int *values) {
+	LlistCursor *cursor = llistCursor_new();
+	size_t nb = 0, i;
+
+	while (values[nb] != -1) {
+		nb++;
+	}
+	assert(llist_size(llist) == nb);
+
+	assert(llistCursor_getHead(llist, cursor) == 0);
+	for (i = 0; i < nb; i++) {
+		assert(*(int *)llistCursor_getData(llist, cursor) == values[i]);
+		assert(llistCursor_getNext(llist, cursor) == ((i + 1 < nb) ? 0 : -1));
+	}
+	for (i = nb; i-- > 0; ) {
+		assert(*(int *)llistCursor_getData(llist, cursor) == values[i]);
+		assert(llistCursor_getPrev(llist, cursor) == ((i > 0) ? 0 : -1));
+	}
+	assert(llistCursor_destroy(&cursor) == 0);
+}
+
+
+void
+testSplice(void) {
+	int values[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	int i;
+	LinkedList *llist1 = llist_newPooled(countDestroy, cmpFunc, 4);
+	LinkedList *llist2, *llist3, *other = llist_new(NULL, cmpFunc);
+	LlistCursor *dst = llistCursor_new();
+	LlistCursor *first = llistCursor_new();
+	LlistCursor *last = llistCursor_new();
+
+	for (i = 0; i < 10; i++) {
+		assert(0 == llist_insertTail(llist1, &values[i]));
+	}
+
+	/* Split in the middle, the new list shares the pool */
+	assert(0 == llistCursor_seek(llist1, dst, 6));
+	llist2 = llist_splitAt(llist1, dst);
+	assert(llist2 != NULL);
+	{
+		int expected1[] = { 0, 1, 2, 3, 4, 5, -1 };
+		int expected2[] = { 6, 7, 8, 9, -1 };
+
+		checkInts(llist1, expected1);
+		checkInts(llist2, expected2);
+	}
+
+	/* Move 1..3 after 7 */
+	assert(0 == llistCursor_seek(llist1, first, 1));
+	assert(0 == llistCursor_seek(llist1, last, 3));
+	assert(0 == llistCursor_seek(llist2, dst, 1));
+	assert(0 == llist_splice(llist2, dst, llist1, first, last, LLIST_AFTER));
+	{
+		int expected1[] = { 0, 4, 5, -1 };
+		int expected2[] = { 6, 7, 1, 2, 3, 8, 9, -1 };
+
+		checkInts(llist1, expected1);
+		checkInts(llist2, expected2);
+	}
+
+	/* Move the head and the tail within the same list */
+	assert(0 == llistCursor_getHead(llist2, first));
+	assert(0 == llistCursor_getTail(llist2, dst));
+	assert(0 == llist_splice(llist2, dst, llist2, first, first, LLIST_AFTER));
+	{
+		int expected2[] = { 7, 1, 2, 3, 8, 9, 6, -1 };
+
+		checkInts(llist2, expected2);
+	}
+
+	/* Splitting at the head moves everything */
+	assert(0 == llistCursor_getHead(llist1, first));
+	llist3 = llist_splitAt(llist1, first);
+	assert(llist3 != NULL && llist_size(llist1) == 0);
+	assert(0 == llist_concat(llist3, llist2));
+	assert(0 == llist_concat(llist1, llist3));
+	{
+		int expected1[] = { 0, 4, 5, 7, 1, 2, 3, 8, 9, 6, -1 };
+		int empty[] = { -1 };
+
+		checkInts(llist1, expected1);
+		checkInts(llist2, empty);
+		checkInts(llist3, empty);
+	}
+
+	/* Nodes can't move between lists which don't free them the same way */
+	assert(0 == llist_insertTail(other, &values[0]));
+	assert(0 == llistCursor_getHead(other, first));
+	assert(-1 == llist_splice(llist1, dst, other, first, first, LLIST_AFTER));
+	assert(-1 == llist_concat(llist1, other));
+	assert(-2 == llist_concat(llist1, llist1));
+
+	/* Splice into an empty list */
+	assert(0 == llistCursor_getHead(llist1, first));
+	assert(0 == llistCursor_getTail(llist1, last));
+	assert(0 == llistCursor_getHead(llist2, dst));
+	assert(0 == llist_splice(llist2, dst, llist1, first, last, LLIST_BEFORE));
+	assert(llist_size(llist1) == 0 && llist_size(llist2) == 10);
+
+	nbDestroyed = 0;
+	assert(llist_destroy(&llist1) == 0);
+	assert(llist_destroy(&llist3) == 0);
+	assert(nbDestroyed == 0);
+	assert(llist_destroy(&llist2) == 0);
+	assert(nbDestroyed == 10);
+	assert(llist_destroy(&other) == 0);
+
+	assert(llistCursor_destroy(&dst) == 0);
+	assert(llistCursor_destroy(&first) == 0);
+	assert(llistCursor_destroy(&last) == 0);
+}
+
+
+size_t
+hashInt(void *data) {
+	return (size_t)*((int *)data) * 2654435761u;
+}
+
+
+/* Finds key from cursor in both lists, the results must be the same Node data */
+static void
+checkSameFind(LinkedList *indexed, LinkedList *plain, size_t pos, int key, LlistDirection dir) {
+	LlistCursor *cursor1 = llistCursor_new();
+	LlistCursor *cursor2 = llistCursor_new();
+	int ret;
+
+	assert(0 == llistCursor_seek(indexed, cursor1, pos));
+	assert(0 == llistCursor_seek(plain, cursor2, pos));
+	ret = llistCursor_find(indexed, cursor1, &key, dir);
+	assert(ret == llistCursor_find(plain, cursor2, &key, dir));
+	assert(llistCursor_getData(indexed, cursor1) == llistCursor_getData(plain, cursor2));
+
+	assert(llistCursor_destroy(&cursor1) == 0);
+	assert(llistCursor_destroy(&cursor2) == 0);
+}
+
+
+void
+testIndex(void) {
+	int values[400];
+	size_t step;
+	int key;
+	unsigned long rand = 777;
+	LinkedList *indexed = llist_newPooled(NULL, cmpFunc, 32);
+	LinkedList *plain = llist_new(NULL, cmpFunc);
+	LlistCursor *cursor1 = llistCursor_new();
+	LlistCursor *cursor2 = llistCursor_new();
+
+	for (step = 0; step < 400; step++) {
+		values[step] = (int)(step % 150);
+	}
+
+	/* Index a list which already has data */
+	for (step = 0; step < 50; step++) {
+		assert(0 == llist_insertTail(indexed, &values[step * 7]));
+		assert(0 == llist_insertTail(plain, &values[step * 7]));
+	}
+	assert(0 == llist_enableIndex(indexed, hashInt));
+
+	for (step = 0; step < 3000; step++) {
+		size_t size = llist_size(plain);
+		size_t pos;
+		int op;
+
+		assert(llist_size(indexed) == size);
+
+		rand = rand * 1103515245 + 12345;
+		op = (int)((rand >> 16) % 6);
+		pos = (size > 0) ? (rand >> 8) % size : 0;
+		key = (int)((rand >> 4) % 160);
+
+		if (size == 0 || (op < 3 && size < 300)) {
+			int *data = &values[(rand >> 12) % 400];
+
+			if (size == 0 || op == 0) {
+				assert(0 == llist_insertHead(indexed, data));
+				assert(0 == llist_insertHead(plain, data));
+			} else if (op == 1) {
+				assert(0 == llist_insertTail(indexed, data));
+				assert(0 == llist_insertTail(plain, data));
+			} else {
+				assert(0 == llistCursor_seek(indexed, cursor1, pos));
+				assert(0 == llistCursor_seek(plain, cursor2, pos));
+				assert(0 == llistCursor_insertData(indexed, cursor1, data, LLIST_BEFORE));
+				assert(0 == llistCursor_insertData(plain, cursor2, data, LLIST_BEFORE));
+			}
+		} else if (op == 3) {
+			assert(llist_popHead(indexed) == llist_popHead(plain));
+		} else if (op == 4) {
+			assert(0 == llistCursor_seek(indexed, cursor1, pos));
+			assert(0 == llistCursor_seek(plain, cursor2, pos));
+			assert(llist_popNode(indexed, cursor1) == llist_popNode(plain, cursor2));
+		} else {
+			int *data = &values[(rand >> 12) % 400];
+
+			assert(0 == llistCursor_seek(indexed, cursor1, pos));
+			assert(0 == llistCursor_seek(plain, cursor2, pos));
+			assert(0 == llistCursor_setData(indexed, cursor1, data));
+			assert(0 == llistCursor_setData(plain, cursor2, data));
+		}
+
+		size = llist_size(plain);
+		assert(llist_countMatch(indexed, &key) == llist_countMatch(plain, &key));
+		if (size > 0) {
+			checkSameFind(indexed, plain, 0, key, LLIST_AFTER);
+			checkSameFind(indexed, plain, size - 1, key, LLIST_BEFORE);
+			checkSameFind(indexed, plain, pos % size, key, LLIST_AFTER);
+			checkSameFind(indexed, plain, pos % size, key, LLIST_BEFORE);
+		}
+	}
+
+	/* Indexed lists can't exchange Nodes */
+	assert(0 == llistCursor_getHead(indexed, cursor1));
+	assert(llist_splitAt(indexed, cursor1) == NULL);
+
+	/* Sorting doesn't change which Nodes hold which data */
+	assert(0 == llist_mergeSort(indexed));
+	for (key = 0; key < 150; key++) {
+		assert(llist_countMatch(indexed, &key) == llist_countMatch(plain, &key));
+	}
+
+	assert(0 == llist_disableIndex(indexed));
+	key = 3;
+	assert(llist_countMatch(indexed, &key) == llist_countMatch(plain, &key));
+
+	assert(llistCursor_destroy(&cursor1) == 0);
+	assert(llistCursor_destroy(&cursor2) == 0);
+	assert(llist_enableIndex(indexed, hashInt) == 0);
+	assert(llist_destroy(&indexed) == 0);
+	assert(llist_destroy(&plain) == 0);
+}
+
+
+/* Checks llist is sorted by key (then seq if b_checkSeq), walking both ways,
+ * returns its size */
+static size_t
+checkSortedPairs(LinkedList *llist, int b_checkSeq) {
+	LlistCursor *cursor = llistCursor_new();
+	Pair *prev = NULL;
+	size_t nb = 0;
+
+	if (llistCursor_getHead(llist, cursor) == 0 && llistCursor_getData(llist, cursor) != NULL) {
+		do {
+			Pair *cur = llistCursor_getData(llist, cursor);
+
+			if (prev != NULL) {
+				assert(prev->key < cur->key || (prev->key == cur->key && (!b_checkSeq || prev->seq < cur->seq)));
+			}
+			prev = cur;
+			nb++;
+		} while (llistCursor_getNext(llist, cursor) == 0);
+
+		do {
+			nb--;
+		} while (llistCursor_getPrev(llist, cursor) == 0);
+		assert(nb == 0);
+		nb = llist_size(llist);
+	}
+
+	assert(llistCursor_destroy(&cursor) == 0);
+	return nb;
+}
+
+
+void
+testOrdered(void) {
+	Pair pairs[2000];
+	Pair probe;
+	int i;
+	unsigned long rand = 99;
+	LinkedList *ordered = llist_newOrdered(countDestroy, cmpPair);
+	LinkedList *plain = llist_new(NULL, cmpPair);
+	LlistCursor *cursor1 = llistCursor_new();
+	LlistCursor *cursor2 = llistCursor_new();
+
+	for (i = 0; i < 2000; i++) {
+		rand = rand * 1103515245 + 12345;
+		pairs[i].key = (int)((rand >> 16) % 500);
+		pairs[i].seq = i;
+		assert(0 == llist_insertSorted(ordered, &pairs[i]));
+		assert(0 == llist_insertSorted(plain, &pairs[i]));
+	}
+	assert(checkSortedPairs(ordered, 1) == 2000);
+	assert(checkSortedPairs(plain, 1) == 2000);
+
+	/* Bounds match the linear ones of a plain sorted list */
+	for (probe.key = -1; probe.key <= 501; probe.key++) {
+		int ret;
+
+		ret = llist_lowerBound(ordered, cursor1, &probe);
+		assert(ret == llist_lowerBound(plain, cursor2, &probe));
+		if (ret == 0) {
+			assert(llistCursor_getData(ordered, cursor1) == llistCursor_getData(plain, cursor2));
+			assert(((Pair *)llistCursor_getData(ordered, cursor1))->key >= probe.key);
+			if (llistCursor_getPrev(ordered, cursor1) == 0) {
+				assert(((Pair *)llistCursor_getData(ordered, cursor1))->key < probe.key);
+			}
+		}
+
+		ret = llist_upperBound(ordered, cursor1, &probe);
+		assert(ret == llist_upperBound(plain, cursor2, &probe));
+		if (ret == 0) {
+			assert(llistCursor_getData(ordered, cursor1) == llistCursor_getData(plain, cursor2));
+			assert(((Pair *)llistCursor_getData(ordered, cursor1))->key > probe.key);
+		}
+	}
+	probe.key = 1000;
+	assert(llist_lowerBound(ordered, cursor1, &probe) == -1);
+	assert(llist_lowerBound(ordered, NULL, &probe) == -2);
+
+	/* Nothing may break the order */
+	assert(llist_insertHead(ordered, &pairs[0]) == -2);
+	assert(llist_insertTail(ordered, &pairs[0]) == -2);
+	assert(0 == llistCursor_getHead(ordered, cursor1));
+	assert(llistCursor_insertData(ordered, cursor1, &pairs[0], LLIST_AFTER) == -4);
+	assert(llistCursor_setData(ordered, cursor1, &probe) == -2);
+	assert(llist_splitAt(ordered, cursor1) == NULL);
+	assert(0 == llist_mergeSort(ordered));
+
+	/* Remove about half of it through every path, then keep inserting */
+	nbDestroyed = 0;
+	for (i = 0; i < 1000; i++) {
+		rand = rand * 1103515245 + 12345;
+		switch ((rand >> 16) % 4) {
+		case 0:
+			assert(llist_popHead(ordered) != NULL);
+			break;
+		case 1:
+			assert(llist_popTail(ordered) != NULL);
+			break;
+		case 2:
+			assert(0 == llistCursor_seek(ordered, cursor1, (rand >> 4) % llist_size(ordered)));
+			assert(llist_popNode(ordered, cursor1) != NULL);
+			break;
+		default:
+			assert(0 == llistCursor_seek(ordered, cursor1, (rand >> 4) % llist_size(ordered)));
+			assert(0 == llist_removeNode(ordered, cursor1));
+			break;
+		}
+	}
+	assert(checkSortedPairs(ordered, 1) == 1000);
+	for (i = 0; i < 1000; i++) {
+		assert(0 == llist_insertSorted(ordered, &pairs[i]));
+	}
+	/* Reinserted data goes after equal data which is already there */
+	assert(checkSortedPairs(ordered, 0) == 2000);
+
+	for (probe.key = 0; probe.key < 500; probe.key += 7) {
+		if (llist_lowerBound(ordered, cursor1, &probe) == 0) {
+			assert(((Pair *)llistCursor_getData(ordered, cursor1))->key >= probe.key);
+		}
+	}
+
+	assert(llistCursor_destroy(&cursor1) == 0);
+	assert(llistCursor_destroy(&cursor2) == 0);
+	assert(llist_destroy(&plain) == 0);
+	nbDestroyed = 0;
+	assert(llist_destroy(&ordered) == 0);
+	assert(nbDestroyed == 2000);
+}
+
+
+#define CQUEUE_THREADS 4
+#define CQUEUE_ITEMS 20000
+
+
+typedef struct {
+	ConcurrentQueue *queue;
+	int *items;
+	int first;
+	int nbPopped;
+} QueueWorker;
+
+
+void *
+queueProducer(void *arg) {
+	QueueWorker *worker = arg;
+	int i;
+
+	for (i = worker->first; i < worker->first + CQUEUE_ITEMS; i++) {
+		assert(0 == cqueue_insertTail(worker->queue, &(worker->items[i])));
+	}
+
+	return NULL;
+}
+
+
+/* Each consumer marks what it pops, so an item seen twice shows up as a 2 */
+void *
+queueConsumer(void *arg) {
+	QueueWorker *worker = arg;
+
+	while (worker->nbPopped < CQUEUE_ITEMS) {
+		int *item = cqueue_popHead(worker->queue);
+
+		if (item != NULL) {
+			(*item)++;
+			worker->nbPopped++;
+		}
+	}
+
+	return NULL;
+}
+
+
+void
+testConcurrentQueue(void) {
+	static int items[CQUEUE_THREADS * CQUEUE_ITEMS];
+	QueueWorker producers[CQUEUE_THREADS], consumers[CQUEUE_THREADS];
+	pthread_t threads[2 * CQUEUE_THREADS];
+	ConcurrentQueue *queue = cqueue_new(countDestroy);
+	AllocCounter counter = { 0, 0 };
+	LlistAllocator counting;
+	int i;
+
+	assert(queue != NULL);
+	assert(cqueue_isEmpty(queue) == 1);
+	assert(cqueue_popHead(queue) == NULL);
+
+	for (i = 0; i < CQUEUE_THREADS; i++) {
+		producers[i].queue = consumers[i].queue = queue;
+		producers[i].items = consumers[i].items = items;
+		producers[i].first = i * CQUEUE_ITEMS;
+		consumers[i].nbPopped = 0;
+		assert(0 == pthread_create(&threads[2 * i], NULL, queueProducer, &producers[i]));
+		assert(0 == pthread_create(&threads[2 * i + 1], NULL, queueConsumer, &consumers[i]));
+	}
+	for (i = 0; i < 2 * CQUEUE_THREADS; i++) {
+		assert(0 == pthread_join(threads[i], NULL));
+	}
+
+	for (i = 0; i < CQUEUE_THREADS * CQUEUE_ITEMS; i++) {
+		assert(items[i] == 1);
+	}
+	assert(cqueue_isEmpty(queue) == 1);
+
+	/* Single-threaded, order is kept and leftovers are destroyed */
+	for (i = 0; i < 10; i++) {
+		assert(0 == cqueue_insertTail(queue, &items[i]));
+	}
+	assert(cqueue_isEmpty(queue) == 0);
+	assert(cqueue_popHead(queue) == &items[0]);
+	assert(cqueue_popHead(queue) == &items[1]);
+
+	nbDestroyed = 0;
+	assert(cqueue_destroy(&queue) == 0);
+	assert(queue == NULL);
+	assert(nbDestroyed == 8);
+
+	/* Everything goes through the allocator, this thread's record is freed
+	 * once it uses another queue */
+	counting.f_alloc = countingAlloc;
+	counting.f_free = countingFree;
+	counting.context = &counter;
+	queue = cqueue_newWithAllocator(NULL, &counting);
+	assert(queue != NULL && counter.nbAllocs == 2);
+	for (i = 0; i < 100; i++) {
+		assert(0 == cqueue_insertTail(queue, &items[i]));
+	}
+	for (i = 0; i < 50; i++) {
+		assert(cqueue_popHead(queue) == &items[i]);
+	}
+	assert(counter.nbAllocs > 102 && counter.nbFrees > 0);
+	assert(cqueue_destroy(&queue) == 0);
+	assert(counter.nbFrees < counter.nbAllocs);
+
+	queue = cqueue_new(NULL);
+	assert(cqueue_isEmpty(queue) == 1);
+	assert(counter.nbFrees == counter.nbAllocs);
+	assert(cqueue_destroy(&queue) == 0);
+}
+
+
+#define CLIST_THREADS 4
+#define CLIST_OPS 20000
+
+
+typedef struct {
+	ConcurrentList *clist;
+	unsigned long rand;
+	long nbInserted;
+	long nbRemoved;
+} ListWorker;
+
+
+/* Random walks mixing inserts and removals anywhere in the list */
+void *
+listStress(void *arg) {
+	static int data = 0;
+	ListWorker *worker = arg;
+	ClistCursor *cursor = clistCursor_new();
+	int i;
+
+	assert(cursor != NULL);
+	for (i = 0; i < CLIST_OPS; i++) {
+		int steps;
+
+		worker->rand = worker->rand * 1103515245 + 12345;
+		if (clistCursor_getHead(worker->clist, cursor) != 0) {
+			assert(0 == clist_insertTail(worker->clist, &data));
+			worker->nbInserted++;
+			continue;
+		}
+		for (steps = (worker->rand >> 8) % 16; steps > 0; steps--) {
+			if (clistCursor_getNext(worker->clist, cursor) != 0) {
+				break;
+			}
+		}
+
+		switch ((worker->rand >> 16) % 5) {
+		case 0:
+			if (clistCursor_insertData(worker->clist, cursor, &data, LLIST_AFTER) == 0) {
+				worker->nbInserted++;
+			}
+			break;
+		case 1:
+			if (clistCursor_insertData(worker->clist, cursor, &data, LLIST_BEFORE) == 0) {
+				worker->nbInserted++;
+			}
+			break;
+		case 2:
+			if (clist_popNode(worker->clist, cursor) != NULL) {
+				worker->nbRemoved++;
+				/* Moving on from a removed Node */
+				assert(clistCursor_getPrev(worker->clist, cursor) > -2);
+			}
+			break;
+		case 3:
+			if (clist_removeNode(worker->clist, cursor) == 0) {
+				worker->nbRemoved++;
+				assert(clistCursor_getNext(worker->clist, cursor) > -2);
+			}
+			break;
+		default:
+			assert(0 == clist_insertHead(worker->clist, &data));
+			worker->nbInserted++;
+			break;
+		}
+	}
+
+	assert(clistCursor_destroy(&cursor) == 0);
+	return NULL;
+}
+
+
+void
+testConcurrentList(void) {
+	int data[5] = { 0, 1, 2, 3, 4 };
+	ListWorker workers[CLIST_THREADS];
+	pthread_t threads[CLIST_THREADS];
+	ConcurrentList *clist = clist_new(countDestroy, cmpFunc);
+	ClistCursor *cursor = clistCursor_new();
+	ClistCursor *other = clistCursor_new();
+	long nbExpected = 0;
+	size_t nb;
+	int i;
+
+	assert(clist != NULL && cursor != NULL && other != NULL);
+	assert(clistCursor_getHead(clist, cursor) == -1);
+	assert(clistCursor_getNext(clist, cursor) == -2);
+
+	for (i = 0; i < 5; i++) {
+		assert(0 == clist_insertTail(clist, &data[i]));
+	}
+	assert(clist_size(clist) == 5);
+	assert(0 == clistCursor_getHead(clist, cursor));
+	assert(0 == clistCursor_findNext(clist, cursor, &data[2]));
+	assert(clistCursor_getData(clist, cursor) == &data[2]);
+	assert(clistCursor_findNext(clist, cursor, &data[1]) == -1);
+	assert(clistCursor_getData(clist, cursor) == &data[2]);
+
+	/* Removing the Node another cursor is on: its data lives until both left */
+	assert(0 == clistCursor_getTail(clist, other));
+	assert(0 == clistCursor_getPrev(clist, other));
+	assert(0 == clistCursor_getPrev(clist, other));
+	nbDestroyed = 0;
+	assert(0 == clist_removeNode(clist, cursor));
+	assert(clist_removeNode(clist, other) == -3);
+	assert(clistCursor_insertData(clist, other, &data[0], LLIST_AFTER) == -3);
+	assert(clistCursor_isRemoved(clist, other) == 1);
+	assert(clist_size(clist) == 4);
+	assert(0 == clistCursor_getNext(clist, cursor));
+	assert(clistCursor_getData(clist, cursor) == &data[3]);
+	assert(nbDestroyed == 0);
+	assert(0 == clistCursor_getPrev(clist, other));
+	assert(clistCursor_getData(clist, other) == &data[1]);
+	assert(nbDestroyed == 1);
+
+	assert(0 == clistCursor_insertData(clist, other, &data[2], LLIST_AFTER));
+	assert(clist_popNode(clist, cursor) == &data[3]);
+	assert(0 == clistCursor_getTail(clist, cursor));
+	assert(clistCursor_getData(clist, cursor) == &data[4]);
+	assert(clistCursor_getNext(clist, cursor) == -1);
+	assert(0 == clistCursor_destroy(&other));
+	other = clistCursor_copy(cursor);
+	assert(0 == clist_removeNode(clist, other));
+	assert(clistCursor_isRemoved(clist, cursor) == 1);
+	assert(0 == clistCursor_destroy(&other));
+	assert(nbDestroyed == 1);
+
+	nbDestroyed = 0;
+	assert(0 == clistCursor_destroy(&cursor));
+	assert(nbDestroyed == 1);
+	assert(clist_destroy(&clist) == 0);
+	assert(nbDestroyed == 4);
+
+	/* No destroy function, since it would run from several threads */
+	clist = clist_new(NULL, cmpFunc);
+	cursor = clistCursor_new();
+	for (i = 0; i < CLIST_THREADS; i++) {
+		workers[i].clist = clist;
+		workers[i].rand = i + 1;
+		workers[i].nbInserted = workers[i].nbRemoved = 0;
+		assert(0 == pthread_create(&threads[i], NULL, listStress, &workers[i]));
+	}
+	for (i = 0; i < CLIST_THREADS; i++) {
+		assert(0 == pthread_join(threads[i], NULL));
+		nbExpected += workers[i].nbInserted - workers[i].nbRemoved;
+	}
+	assert((long)clist_size(clist) == nbExpected);
+
+	/* Every link is consistent both ways */
+	nb = 0;
+	if (clistCursor_getHead(clist, cursor) == 0) {
+		do {
+			nb++;
+		} while (clistCursor_getNext(clist, cursor) == 0);
+		assert(nb == clist_size(clist));
+		do {
+			nb--;
+		} while (clistCursor_getPrev(clist, cursor) == 0);
+		assert(nb == 0);
+	}
+
+	assert(0 == clistCursor_destroy(&cursor));
+	assert(clist_destroy(&clist) == 0);
+}
+
+
+#define EPOCH_READERS 3
+#define EPOCH_WRITES 20000
+
+
+typedef struct {
+	LinkedList *llist;
+	int b_done;
+	long nbSeen;
+} EpochWorker;
+
+
+/* Poisons the data first, so a reader seeing it means it was destroyed too early */
+int
+poisonFree(void *data) {
+	*((int *)data) = -1;
+	free(data);
+	return 0;
+}
+
+
+void *
+epochReader(void *arg) {
+	EpochWorker *worker = arg;
+	LlistReader *reader = llist_newReader(worker->llist);
+	LlistCursor *cursor = llistCursor_new();
+
+	assert(reader != NULL && cursor != NULL);
+	while (!__atomic_load_n(&(worker->b_done), __ATOMIC_ACQUIRE)) {
+		llist_readBegin(worker->llist, reader);
+		if (llistCursor_getHead(worker->llist, cursor) == 0 && *cursor != NULL) {
+			do {
+				assert(*((int *)llistCursor_getData(worker->llist, cursor)) >= 0);
+				worker->nbSeen++;
+			} while (llistCursor_getNext(worker->llist, cursor) == 0);
+		}
+		llist_readEnd(worker->llist, reader);
+	}
+
+	assert(llistCursor_destroy(&cursor) == 0);
+	assert(llist_destroyReader(&reader) == 0);
+	return NULL;
+}
+
+
+int *
+newInt(int value) {
+	int *p = malloc(sizeof (*p));
+
+	assert(p != NULL);
+	*p = value;
+	return p;
+}
+
+
+void
+testEpochs(void) {
+	int data[4] = { 0, 1, 2, 3 };
+	EpochWorker workers[EPOCH_READERS];
+	pthread_t threads[EPOCH_READERS];
+	LinkedList *llist = llist_new(countDestroy, cmpFunc);
+	LinkedList *other = llist_new(countDestroy, cmpFunc);
+	LlistCursor *writer = llistCursor_new();
+	LlistCursor *cursor = llistCursor_new();
+	LlistReader *reader;
+	int i;
+
+	assert(llist_newReader(llist) == NULL);
+	assert(llist_synchronize(llist) == -1);
+	assert(0 == llist_enableEpochs(llist));
+	assert(0 == llist_enableEpochs(llist));
+	for (i = 0; i < 4; i++) {
+		assert(0 == llist_insertTail(llist, &data[i]));
+	}
+	assert(llist_concat(llist, other) == -1);
+	assert(llist_concat(other, llist) == -1);
+	assert(llist_destroy(&other) == 0);
+	assert(0 == llistCursor_seek(llist, cursor, 2));
+	assert(llist_splitAt(llist, cursor) == NULL && llist_size(llist) == 4);
+
+	/* A reader on a removed Node can still use it and move on from it */
+	reader = llist_newReader(llist);
+	assert(reader != NULL);
+	llist_readBegin(llist, reader);
+	assert(0 == llistCursor_getHead(llist, cursor));
+	assert(0 == llistCursor_getNext(llist, cursor));
+
+	nbDestroyed = 0;
+	assert(0 == llistCursor_seek(llist, writer, 1));
+	assert(0 == llist_removeNode(llist, writer));
+	assert(0 == llistCursor_getTail(llist, writer));
+	assert(llist_popNode(llist, writer) == &data[3]);
+	assert(llist_size(llist) == 2);
+	assert(nbDestroyed == 0);
+
+	assert(llistCursor_getData(llist, cursor) == &data[1]);
+	assert(0 == llistCursor_getNext(llist, cursor));
+	assert(llistCursor_getData(llist, cursor) == &data[2]);
+	assert(llistCursor_getNext(llist, cursor) == -1);
+	llist_readEnd(llist, reader);
+
+	assert(0 == llist_synchronize(llist));
+	assert(nbDestroyed == 1);
+	assert(0 == llist_destroyReader(&reader));
+	assert(reader == NULL);
+
+	/* The destroyed reader's record gets reused */
+	reader = llist_newReader(llist);
+	assert(reader != NULL);
+	assert(0 == llist_destroyReader(&reader));
+
+	/* Removed Nodes still waiting for reclaim go with the list */
+	assert(0 == llistCursor_getHead(llist, writer));
+	assert(0 == llist_removeNode(llist, writer));
+	nbDestroyed = 0;
+	assert(llist_destroy(&llist) == 0);
+	assert(nbDestroyed == 2);
+
+	/* One writer replacing Nodes while readers keep walking the list */
+	llist = llist_new(poisonFree, cmpFunc);
+	assert(0 == llist_enableEpochs(llist));
+	for (i = 0; i < 100; i++) {
+		assert(0 == llist_insertTail(llist, newInt(i)));
+	}
+	for (i = 0; i < EPOCH_READERS; i++) {
+		workers[i].llist = llist;
+		workers[i].b_done = 0;
+		workers[i].nbSeen = 0;
+		assert(0 == pthread_create(&threads[i], NULL, epochReader, &workers[i]));
+	}
+
+	for (i = 0; i < EPOCH_WRITES; i++) {
+		assert(0 == llistCursor_seek(llist, writer, (i * 7) % llist_size(llist)));
+		assert(0 == llist_removeNode(llist, writer));
+		if (i % 2 == 0) {
+			assert(0 == llist_insertTail(llist, newInt(i)));
+		} else {
+			assert(0 == llist_insertHead(llist, newInt(i)));
+		}
+	}
+
+	for (i = 0; i < EPOCH_READERS; i++) {
+		__atomic_store_n(&(workers[i].b_done), 1, __ATOMIC_RELEASE);
+		assert(0 == pthread_join(threads[i], NULL));
+	}
+	assert(llist_size(llist) == 100);
+
+	assert(llistCursor_destroy(&cursor) == 0);
+	assert(llistCursor_destroy(&writer) == 0);
+	assert(llist_destroy(&llist) == 0);
+}
+
+
+void
+testParallelSort(void) {
+	static Pair pairs[50000];
+	size_t nbThreads[] = { 0, 1, 2, 3, 4, 7, 100 };
+	unsigned long rand = 7;
+	size_t t;
+	int i;
+
+	for (t = 0; t < sizeof (nbThreads) / sizeof (nbThreads[0]); t++) {
+		LinkedList *llist = llist_new(NULL, cmpPair);
+
+		for (i = 0; i < 50000; i++) {
+			rand = rand * 1103515245 + 12345;
+			pairs[i].key = (int)((rand >> 16) % 1000);
+			pairs[i].seq = i;
+			assert(0 == llist_insertTail(llist, &pairs[i]));
+		}
+
+		assert(0 == llist_parallelSort(llist, nbThreads[t]));
+		assert(checkSortedPairs(llist, 1) == 50000);
+		assert(0 == llist_parallelSort(llist, nbThreads[t]));
+		assert(checkSortedPairs(llist, 1) == 50000);
+
+		assert(llist_destroy(&llist) == 0);
+	}
+}
+
+
+static unsigned long
+pairKey(void *data) {
+	return (unsigned long)((Pair *)data)->key;
+}
+
+
+/* Spreads keys over every byte of the key, keeping their order */
+static unsigned long
+spreadPairKey(void *data) {
+	unsigned long key = (unsigned long)((Pair *)data)->key;
+
+	return (key << (8 * sizeof (unsigned long) - 10)) | (key * 0x10101UL);
+}
+
+
+void
+testSortByKey(void) {
+	static Pair pairs[20000];
+	LinkedList *llist = llist_new(NULL, cmpPair);
+	unsigned long rand = 11;
+	int i;
+
+	/* Empty and single element lists */
+	assert(0 == llist_sortByKey(llist, pairKey));
+	assert(0 == llist_sortByKey(llist, NULL));
+	pairs[0].key = 0, pairs[0].seq = 0;
+	assert(0 == llist_insertTail(llist, &pairs[0]));
+	assert(0 == llist_sortByKey(llist, pairKey));
+	assert(0 == llist_sortByKey(llist, NULL));
+	assert(llist_getHeadData(llist) == &pairs[0] && llist_getTailData(llist) == &pairs[0]);
+	assert(llist_popHead(llist) == &pairs[0]);
+
+	for (i = 0; i < 20000; i++) {
+		rand = rand * 1103515245 + 12345;
+		pairs[i].key = (int)((rand >> 16) % 1000);
+		pairs[i].seq = i;
+		assert(0 == llist_insertTail(llist, &pairs[i]));
+	}
+
+	/* Radix sort is stable, whichever bytes the keys use */
+	assert(0 == llist_sortByKey(llist, pairKey));
+	assert(checkSortedPairs(llist, 1) == 20000);
+	assert(0 == llist_sortByKey(llist, spreadPairKey));
+	assert(checkSortedPairs(llist, 1) == 20000);
+
+	/* Introsort on random, sorted, reversed and equal keys */
+	assert(0 == llist_mergeSort(llist));
+	for (i = 0; i < 20000; i++) {
+		assert(llist_popHead(llist) != NULL);
+		assert(0 == llist_insertTail(llist, &pairs[(i * 7919) % 20000]));
+	}
+	assert(0 == llist_sortByKey(llist, NULL));
+	assert(checkSortedPairs(llist, 0) == 20000);
+	assert(0 == llist_sortByKey(llist, NULL));
+	assert(checkSortedPairs(llist, 0) == 20000);
+	for (i = 0; i < 20000; i++) {
+		pairs[i].key = 20000 - i;
+		assert(llist_popHead(llist) != NULL);
+		assert(0 == llist_insertTail(llist, &pairs[i]));
+	}
+	assert(0 == llist_sortByKey(llist, NULL));
+	assert(checkSortedPairs(llist, 0) == 20000);
+	assert(llist_getHeadData(llist) == &pairs[19999] && llist_getTailData(llist) == &pairs[0]);
+	for (i = 0; i < 20000; i++) {
+		pairs[i].key = 3;
+	}
+	assert(0 == llist_sortByKey(llist, NULL));
+	assert(checkSortedPairs(llist, 0) == 20000);
+
+	assert(llist_destroy(&llist) == 0);
+}
+
+
+void
+testMergeSorted(void) {
+	static Pair pairs[5][1000];
+	LinkedList *lists[5];
+	LinkedList *other = llist_newPooled(NULL, cmpPair, 0);
+	int i, j;
+
+	/* Sorted lists of different sizes with keys in common, seq grows with
+	 * the list then the position */
+	for (j = 0; j < 5; j++) {
+		lists[j] = llist_new(NULL, cmpPair);
+		for (i = 0; i < 200 * j; i++) {
+			pairs[j][i].key = i / (j + 1);
+			pairs[j][i].seq = j * 1000 + i;
+			assert(0 == llist_insertTail(lists[j], &pairs[j][i]));
+		}
+	}
+
+	/* Empty lists, invalid arguments */
+	assert(llist_mergeSorted(lists[1], lists[1]) == -2);
+	assert(llist_mergeSorted(lists[1], NULL) == -2);
+	assert(llist_mergeK(lists, 0) == -2);
+	assert(llist_mergeK(NULL, 2) == -2);
+	assert(0 == llist_mergeSorted(lists[1], lists[0]));
+	assert(checkSortedPairs(lists[1], 1) == 200);
+	assert(0 == llist_mergeSorted(lists[0], lists[1]));
+	assert(checkSortedPairs(lists[0], 1) == 200 && llist_size(lists[1]) == 0);
+	assert(0 == llist_mergeSorted(lists[1], lists[0]));
+
+	/* Nothing moves when one of the lists can't give its Nodes */
+	assert(llist_destroy(&lists[0]) == 0);
+	lists[0] = other;
+	assert(llist_mergeK(lists, 5) == -1);
+	assert(llist_size(lists[1]) == 200 && llist_size(lists[4]) == 800);
+	other = lists[0];
+	lists[0] = llist_new(NULL, cmpPair);
+
+	/* Ties keep the order of the lists */
+	assert(0 == llist_mergeK(lists, 5));
+	assert(checkSortedPairs(lists[0], 1) == 2000);
+	for (j = 1; j < 5; j++) {
+		assert(llist_size(lists[j]) == 0);
+	}
+	assert(0 == llist_mergeK(lists, 1));
+	assert(checkSortedPairs(lists[0], 1) == 2000);
+
+	/* Merged lists are usable again */
+	pairs[0][0].key = 1000, pairs[0][0].seq = 0;
+	assert(0 == llist_insertTail(lists[3], &pairs[0][0]));
+	assert(0 == llist_mergeSorted(lists[3], lists[0]));
+	assert(llist_size(lists[3]) == 2001 && llist_getTailData(lists[3]) == &pairs[0][0]);
+	assert(llist_getHeadData(lists[3]) == &pairs[1][0]);
+
+	for (j = 0; j < 5; j++) {
+		assert(llist_destroy(&lists[j]) == 0);
+	}
+	assert(llist_destroy(&other) == 0);
+}
+
+
+/* Fills llist with pointers to values (which ends with -1) */
+static LinkedList *
+fillInts(LinkedList *llist, int *values) {
+	int i;
+
+	for (i = 0; values[i] != -1; i++) {
+		assert(0 == llist_insertTail(llist, &values[i]));
+	}
+	return llist;
+}
+
+
+void
+testSetOps(void) {
+	int a[] = { 1, 2, 2, 4, 6, 8, -1 };
+	int b[] = { 2, 3, 4, 4, 9, -1 };
+	int dups[] = { 1, 1, 2, 3, 3, 3, 7, -1 };
+	LinkedList *llist1, *llist2, *indexed, *empty;
+
+	/* Union, Nodes of src equal to Nodes of dst are dropped */
+	llist1 = fillInts(llist_new(countDestroy, cmpFunc), a);
+	llist2 = fillInts(llist_new(countDestroy, cmpFunc), b);
+	nbDestroyed = 0;
+	assert(llist_setUnion(llist1, llist1) == -2);
+	assert(llist_setUnion(llist1, NULL) == -2);
+	assert(0 == llist_setUnion(llist1, llist2));
+	{
+		int expected[] = { 1, 2, 2, 3, 4, 4, 6, 8, 9, -1 };
+
+		checkInts(llist1, expected);
+	}
+	assert(nbDestroyed == 2 && llist_size(llist2) == 0);
+	assert(0 == llist_insertTail(llist2, &b[4]));
+	assert(llist_destroy(&llist1) == 0 && llist_destroy(&llist2) == 0);
+
+	/* Nodes can't go to a list allocating them differently */
+	llist1 = fillInts(llist_newPooled(countDestroy, cmpFunc, 0), a);
+	llist2 = fillInts(llist_new(countDestroy, cmpFunc), b);
+	assert(llist_setUnion(llist1, llist2) == -1);
+	assert(llist_size(llist2) == 5);
+
+	/* Intersection, src is only read and can be indexed */
+	indexed = fillInts(llist_new(NULL, cmpFunc), b);
+	assert(0 == llist_enableIndex(indexed, hashInt));
+	nbDestroyed = 0;
+	assert(llist_setIntersect(llist1, llist1) == -2);
+	assert(0 == llist_setIntersect(llist1, indexed));
+	{
+		int expected[] = { 2, 4, -1 };
+
+		checkInts(llist1, expected);
+	}
+	assert(nbDestroyed == 4 && llist_size(indexed) == 5);
+	assert(llist_setIntersect(indexed, llist1) == -1);
+	assert(llist_destroy(&llist1) == 0);
+
+	/* Difference */
+	llist1 = fillInts(llist_new(countDestroy, cmpFunc), a);
+	nbDestroyed = 0;
+	assert(0 == llist_setDifference(llist1, llist2));
+	{
+		int expected[] = { 1, 2, 6, 8, -1 };
+
+		checkInts(llist1, expected);
+	}
+	assert(nbDestroyed == 2 && llist_size(llist2) == 5);
+	assert(llist_setDifference(indexed, llist1) == -1);
+	assert(llist_destroy(&llist1) == 0);
+
+	/* Subtracting an empty list does nothing, intersecting with it empties */
+	llist1 = fillInts(llist_new(countDestroy, cmpFunc), a);
+	empty = llist_new(NULL, cmpFunc);
+	nbDestroyed = 0;
+	assert(0 == llist_setDifference(llist1, empty));
+	assert(llist_size(llist1) == 6 && nbDestroyed == 0);
+	assert(0 == llist_setIntersect(llist1, empty));
+	assert(llist_size(llist1) == 0 && nbDestroyed == 6);
+	assert(0 == llist_insertTail(llist1, &a[0]) && llist_getTailData(llist1) == &a[0]);
+	assert(llist_destroy(&empty) == 0);
+	assert(llist_destroy(&llist1) == 0);
+
+	/* Dedup */
+	llist1 = llist_new(countDestroy, cmpFunc);
+	assert(0 == llist_unique(llist1));
+	fillInts(llist1, dups);
+	nbDestroyed = 0;
+	assert(0 == llist_unique(llist1));
+	{
+		int expected[] = { 1, 2, 3, 7, -1 };
+
+		checkInts(llist1, expected);
+	}
+	assert(nbDestroyed == 3);
+	assert(0 == llist_unique(llist1) && nbDestroyed == 3);
+	assert(llist_unique(indexed) == -1);
+
+	assert(llist_destroy(&indexed) == 0);
+	assert(llist_destroy(&llist1) == 0);
+	assert(llist_destroy(&llist2) == 0);
+}
+
+
+typedef struct {
+	long sum;
+	int first;
+	int last;
+} Span;
+
+
+int
+sumVisit(void *data, void *context) {
+	__atomic_fetch_add((long *)context, *((int *)data), __ATOMIC_RELAXED);
+	return 0;
+}
+
+
+/* Bulk calls from within bulk calls */
+typedef struct {
+	LinkedList *inner;
+	long nbFound;
+} NestedVisit;
+
+
+int
+nestedVisit(void *data, void *context) {
+	NestedVisit *nested = context;
+	long sum = 0;
+
+	assert(0 == llist_forEach(nested->inner, 4, sumVisit, &sum));
+	assert(sum == 100L * 99 / 2);
+	__atomic_fetch_add(&(nested->nbFound), (long)llist_parallelCountMatch(nested->inner, data, 4), __ATOMIC_RELAXED);
+	return 0;
+}
+
+
+/* Stops on the data equal to *context */
+int
+stopVisit(void *data, void *context) {
+	return (*((int *)data) == *((int *)context)) ? 7 : 0;
+}
+
+
+/* Points to the same index in the array after it (context) */
+void *
+shiftMap(void *data, void *context) {
+	return (int *)data + *((int *)context);
+}
+
+
+void
+spanReduce(void *acc, void *data, void *context) {
+	Span *span = acc;
+
+	(void)context;
+	if (span->first < 0) {
+		span->first = *((int *)data);
+	}
+	span->last = *((int *)data);
+	span->sum += *((int *)data);
+}
+
+
+/* Not commutative: the order chunks get combined in shows */
+void
+spanCombine(void *acc, void *partial, void *context) {
+	Span *span = acc;
+	Span *other = partial;
+
+	(void)context;
+	if (other->first < 0) {
+		return;
+	}
+	if (span->first < 0) {
+		span->first = other->first;
+	}
+	span->last = other->last;
+	span->sum += other->sum;
+}
+
+
+void
+testBulk(void) {
+	static int data[2 * 10000];
+	size_t nbThreads[] = { 0, 1, 3, 4 };
+	LinkedList *llist = llist_new(NULL, cmpFunc);
+	LinkedList *ordered = llist_newOrdered(NULL, cmpFunc);
+	NestedVisit nested;
+	size_t t;
+	int i;
+
+	nested.inner = llist_new(NULL, cmpFunc);
+	for (i = 0; i < 2 * 10000; i++) {
+		data[i] = (i < 10000) ? i : i - 10000 + 1;
+	}
+	for (i = 0; i < 10000; i++) {
+		assert(0 == llist_insertTail(llist, &data[i]));
+	}
+	for (i = 0; i < 100; i++) {
+		assert(0 == llist_insertTail(nested.inner, &data[i]));
+	}
+
+	for (t = 0; t < sizeof (nbThreads) / sizeof (nbThreads[0]); t++) {
+		long sum = 0;
+		int stopAt = 5000;
+		int shift = 10000;
+		int ten = 10;
+		Span span;
+
+		assert(0 == llist_forEach(llist, nbThreads[t], sumVisit, &sum));
+		assert(sum == 10000L * 9999 / 2);
+		assert(llist_forEach(llist, nbThreads[t], stopVisit, &stopAt) == 7);
+
+		span.sum = 0;
+		span.first = span.last = -1;
+		assert(0 == llist_reduce(llist, nbThreads[t], spanReduce, spanCombine, &span, sizeof (span), NULL));
+		assert(span.sum == 10000L * 9999 / 2 && span.first == 0 && span.last == 9999);
+
+		assert(llist_parallelCountMatch(llist, &ten, nbThreads[t]) == 1);
+
+		nested.nbFound = 0;
+		assert(0 == llist_forEach(llist, nbThreads[t], nestedVisit, &nested));
+		assert(nested.nbFound == 100);
+
+		/* Every data goes to its + 1 in the second half, and back */
+		assert(0 == llist_mapInPlace(llist, nbThreads[t], shiftMap, &shift));
+		assert(*((int *)llist_getHeadData(llist)) == 1 && *((int *)llist_getTailData(llist)) == 10000);
+		assert(llist_parallelCountMatch(llist, &data[0], nbThreads[t]) == 0);
+		shift = -10000;
+		assert(0 == llist_mapInPlace(llist, nbThreads[t], shiftMap, &shift));
+		assert(llist_parallelCountMatch(llist, &data[0], nbThreads[t]) == 1);
+	}
+
+	/* The index follows the new data */
+	assert(0 == llist_enableIndex(llist, hashInt));
+	{
+		int shift = 10000;
+		int probe = 10000;
+
+		assert(llist_countMatch(llist, &probe) == 0);
+		assert(0 == llist_mapInPlace(llist, 4, shiftMap, &shift));
+		assert(llist_countMatch(llist, &probe) == 1);
+		assert(llist_parallelCountMatch(llist, &data[0], 4) == 0);
+	}
+
+	{
+		int shift = 1;
+		long sum = 0;
+
+		assert(llist_mapInPlace(ordered, 4, shiftMap, &shift) == -2);
+		assert(0 == llist_forEach(ordered, 4, sumVisit, &sum));
+		assert(sum == 0);
+	}
+
+	/* Workers come back after being stopped */
+	llist_stopWorkers();
+	assert(llist_parallelCountMatch(llist, &data[10000 + 5], 2) == 1);
+	llist_stopWorkers();
+
+	assert(llist_destroy(&nested.inner) == 0);
+	assert(llist_destroy(&ordered) == 0);
+	assert(llist_destroy(&llist) == 0);
+}
+
+
+/* Counters only move when the library is built with LLIST_STATS (make STATS=1) */
+void
+testStats(void) {
+	int data[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	LinkedList *llist = llist_new(NULL, cmpFunc);
+	LlistCursor *cursor = llistCursor_new();
+	LlistStats stats;
+	int i;
+
+	for (i = 0; i < 10; i++) {
+		assert(0 == llist_insertTail(llist, &data[i]));
+	}
+
+#ifdef LLIST_STATS
+	assert(0 == llist_getStats(llist, &stats));
+	assert(stats.nbAllocs == 10 && stats.nbFrees == 0 && stats.peakSize == 10);
+	assert(stats.nbCmps == 0 && stats.nbTraversed == 0 && stats.nbSwaps == 0);
+
+	assert(llist_countMatch(llist, &data[3]) == 1);
+	assert(0 == llistCursor_getHead(llist, cursor));
+	assert(0 == llistCursor_find(llist, cursor, &data[5], LLIST_AFTER));
+	assert(0 == llist_getStats(llist, &stats));
+	assert(stats.nbTraversed == 10 + 6 && stats.nbCmps == 10 + 6);
+
+	assert(llist_popHead(llist) == &data[0]);
+	assert(llist_popHead(llist) == &data[1]);
+	assert(0 == llist_getStats(llist, &stats));
+	assert(stats.nbFrees == 2 && stats.peakSize == 10);
+
+	llist_resetStats(llist);
+	assert(0 == llist_getStats(llist, &stats));
+	assert(stats.nbAllocs == 0 && stats.nbFrees == 0 && stats.nbCmps == 0 && stats.peakSize == 8);
+
+	/* 9 8 ... 2 takes one swap per pair of Nodes out of order */
+	while (llist_popHead(llist) != NULL) {
+	}
+	for (i = 2; i < 10; i++) {
+		assert(0 == llist_insertHead(llist, &data[i]));
+	}
+	llist_resetStats(llist);
+	assert(0 == llist_bubbleSort(llist));
+	assert(0 == llist_getStats(llist, &stats));
+	assert(stats.nbSwaps == 8 * 7 / 2);
+
+	/* 3 2: one compare to find the runs, one to merge them */
+	while (llist_popHead(llist) != NULL) {
+	}
+	assert(0 == llist_insertTail(llist, &data[3]));
+	assert(0 == llist_insertTail(llist, &data[2]));
+	llist_resetStats(llist);
+	assert(0 == llist_mergeSort(llist));
+	assert(0 == llist_getStats(llist, &stats));
+	assert(stats.nbCmps == 2 && stats.nbSwaps == 1);
+#else
+	assert(llist_getStats(llist, &stats) == -2);
+	assert(stats.nbAllocs == 0 && stats.peakSize == 0);
+	llist_resetStats(llist);
+#endif
+
+	llistCursor_destroy(&cursor);
+	assert(llist_destroy(&llist) == 0);
+}
+
+
+static int nbKeyCmps = 0;
+
+
+static int
+countingCmp(void *my, void *nodeData) {
+	nbKeyCmps++;
+	return cmpFunc(my, nodeData);
+}
+
+
+static unsigned long
+exactKey(void *data) {
+	return (unsigned long)*((int *)data);
+}
+
+
+/* Only a fingerprint: many ints share it */
+static unsigned long
+lowBitsKey(void *data) {
+	return (unsigned long)(*((int *)data) & 7);
+}
+
+
+static void *
+addMap(void *data, void *context) {
+	*((int *)data) += *((int *)context);
+	return data;
+}
+
+
+void
+testKeys(void) {
+	static int values[2000];
+	int small[64];
+	int probe;
+	int shift = 1000;
+	int replaced = 999;
+	LinkedList *exact = llist_new(NULL, countingCmp);
+	LinkedList *fingerprinted = llist_new(NULL, countingCmp);
+	LinkedList *other = llist_new(NULL, countingCmp);
+	LinkedList *split, *pooled, *half;
+	LlistCursor *cursor = llistCursor_new();
+	int i;
+
+	for (i = 0; i < 2000; i++) {
+		values[i] = i % 500;
+		assert(0 == llist_insertTail(exact, &values[i]));
+	}
+	/* Keys of the Nodes already there get computed */
+	assert(0 == llist_setKeyFunc(exact, exactKey, 1));
+	assert(0 == llist_setKeyFunc(fingerprinted, lowBitsKey, 0));
+	for (i = 0; i < 64; i++) {
+		small[i] = i;
+		assert(0 == llist_insertTail(fingerprinted, &small[i]));
+	}
+
+	nbKeyCmps = 0;
+	probe = 7;
+	assert(llist_countMatch(exact, &probe) == 4);
+	assert(llist_parallelCountMatch(exact, &probe, 4) == 4);
+	assert(0 == llistCursor_getHead(exact, cursor));
+	assert(0 == llistCursor_find(exact, cursor, &probe, LLIST_AFTER));
+	assert(llistCursor_getData(exact, cursor) == &values[7]);
+	probe = 600;
+	assert(llistCursor_find(exact, cursor, &probe, LLIST_AFTER) == -1);
+	assert(nbKeyCmps == 0);
+
+	/* Only the 8 Nodes with the same low bits get compared */
+	probe = 13;
+	assert(llist_countMatch(fingerprinted, &probe) == 1);
+	assert(nbKeyCmps == 8);
+
+	/* Keys follow the data */
+	assert(0 == llistCursor_getHead(exact, cursor));
+	probe = 999;
+	assert(0 == llistCursor_setData(exact, cursor, &replaced));
+	assert(llist_countMatch(exact, &probe) == 1);
+	assert(0 == llist_mapInPlace(exact, 4, addMap, &shift));
+	probe = 1000 + 499;
+	assert(llist_countMatch(exact, &probe) == 4);
+	probe = 499;
+	assert(llist_countMatch(exact, &probe) == 0);
+	assert(nbKeyCmps == 8);
+
+	/* Nodes only move between lists with the same keys */
+	assert(llist_concat(other, fingerprinted) == -1);
+	assert(0 == llistCursor_seek(fingerprinted, cursor, 32));
+	split = llist_splitAt(fingerprinted, cursor);
+	assert(split != NULL);
+	probe = 40;
+	assert(llist_countMatch(split, &probe) == 1);
+	assert(0 == llist_concat(fingerprinted, split));
+	assert(0 == llist_setKeyFunc(fingerprinted, NULL, 1));
+	assert(0 == llist_concat(other, fingerprinted));
+	assert(llist_countMatch(other, &probe) == 1);
+
+	/* Keyed Nodes are larger: a list sharing its pool gets one of its own */
+	pooled = llist_newPooled(NULL, countingCmp, 4);
+	assert(0 == llist_setKeyFunc(pooled, lowBitsKey, 0));
+	assert(0 == llist_setKeyFunc(pooled, NULL, 0));
+	for (i = 0; i < 10; i++) {
+		assert(0 == llist_insertTail(pooled, &small[i]));
+	}
+	assert(0 == llistCursor_seek(pooled, cursor, 5));
+	half = llist_splitAt(pooled, cursor);
+	assert(half != NULL);
+	assert(0 == llist_setKeyFunc(half, exactKey, 1));
+	assert(0 == llist_insertTail(half, &small[20]));
+	assert(0 == llist_insertTail(pooled, &small[21]));
+	probe = 20;
+	assert(llist_countMatch(half, &probe) == 1);
+	probe = 7;
+	assert(llist_countMatch(half, &probe) == 1);
+	assert(llist_getHeadData(half) == &small[5] && llist_size(half) == 6);
+	probe = 21;
+	assert(llist_countMatch(pooled, &probe) == 1);
+	assert(llist_concat(pooled, half) == -1);
+	assert(0 == llist_setKeyFunc(half, NULL, 0));
+	assert(llist_concat(pooled, half) == -1);
+	assert(llist_size(half) == 6 && llist_getTailData(half) == &small[20]);
+	assert(llist_destroy(&half) == 0);
+
+	/* Nodes can't move under readers */
+	assert(0 == llist_enableEpochs(pooled));
+	assert(llist_setKeyFunc(pooled, exactKey, 1) == -2);
+	assert(0 == llist_setKeyFunc(pooled, NULL, 1));
+	assert(llist_size(pooled) == 6);
+	assert(llist_destroy(&pooled) == 0);
+
+	assert(llist_destroy(&split) == 0);
+	llistCursor_destroy(&cursor);
+	assert(llist_destroy(&other) == 0);
+	assert(llist_destroy(&fingerprinted) == 0);
+	assert(llist_destroy(&exact) == 0);
+}
+
+
+/* Distance between consecutive Nodes, 0 if it isn't the same all along */
+static ptrdiff_t
+nodeStride(LinkedList *llist) {
+	LlistCursor *cursor = llistCursor_new();
+	ptrdiff_t stride = 0;
+	char *prev;
+
+	llistCursor_getHead(llist, cursor);
+	prev = (char *)*cursor;
+	while (llistCursor_getNext(llist, cursor) == 0) {
+		if (stride == 0) {
+			stride = (char *)*cursor - prev;
+		} else if ((char *)*cursor - prev != stride) {
+			stride = 0;
+			break;
+		}
+		prev = (char *)*cursor;
+	}
+
+	llistCursor_destroy(&cursor);
+	return stride;
+}
+
+
+void
+testCompact(void) {
+	int values[500];
+	LinkedList *plain = llist_new(NULL, cmpFunc);
+	LinkedList *pooled = llist_newPooled(NULL, cmpFunc, 16);
+	LinkedList *ordered = llist_newOrdered(NULL, cmpFunc);
+	LinkedList *epochs = llist_new(NULL, cmpFunc);
+	LlistCursor *cursors[3];
+	LlistCursor *cursor;
+	unsigned long rand = 4242;
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		cursors[i] = llistCursor_new();
+	}
+
+	for (i = 0; i < 500; i++) {
+		values[i] = i;
+	}
+
+	/* Scatter the Nodes with interleaved inserts and removals */
+	for (i = 0; i < 500; i++) {
+		assert(0 == llist_insertTail(plain, &values[i]));
+		assert(0 == llist_insertHead(pooled, &values[i]));
+		assert(0 == llist_insertSorted(ordered, &values[499 - i]));
+	}
+	for (i = 0; i < 300; i++) {
+		rand = rand * 1103515245 + 12345;
+		assert(0 == llistCursor_seek(plain, cursors[0], (rand >> 8) % llist_size(plain)));
+		assert(0 == llist_removeNode(plain, cursors[0]));
+		assert(0 == llistCursor_seek(pooled, cursors[0], (rand >> 8) % llist_size(pooled)));
+		assert(0 == llist_removeNode(pooled, cursors[0]));
+		assert(0 == llist_insertHead(pooled, &values[i]));
+	}
+	assert(0 == llist_enableIndex(plain, hashInt));
+
+	assert(0 == llistCursor_seek(plain, cursors[0], 0));
+	assert(0 == llistCursor_seek(plain, cursors[1], 100));
+	assert(0 == llistCursor_getTail(plain, cursors[2]));
+	{
+		void *first = llistCursor_getData(plain, cursors[0]);
+		void *middle = llistCursor_getData(plain, cursors[1]);
+		void *last = llistCursor_getData(plain, cursors[2]);
+
+		assert(0 == llist_compact(plain, cursors, 3));
+		assert(llistCursor_getData(plain, cursors[0]) == first);
+		assert(llistCursor_getData(plain, cursors[1]) == middle);
+		assert(llistCursor_getData(plain, cursors[2]) == last);
+		assert(nodeStride(plain) > 0);
+		assert(llist_size(plain) == 200);
+	}
+	/* The index and the Nodes added afterwards follow */
+	assert(0 == llistCursor_getHead(plain, cursors[0]));
+	assert(0 == llistCursor_find(plain, cursors[0], llistCursor_getData(plain, cursors[1]), LLIST_AFTER));
+	assert(llist_countMatch(plain, llistCursor_getData(plain, cursors[1])) == 1);
+	assert(0 == llist_insertTail(plain, &values[0]));
+	assert(llist_getTailData(plain) == &values[0] && llist_size(plain) == 201);
+	assert(0 == llistCursor_getTail(plain, cursors[0]));
+	for (i = 1; llistCursor_getPrev(plain, cursors[0]) == 0; i++) {
+	}
+	assert(i == 201 && llistCursor_getData(plain, cursors[0]) == llist_getHeadData(plain));
+
+	assert(0 == llist_compact(pooled, NULL, 0));
+	assert(nodeStride(pooled) > 0 && llist_size(pooled) == 500);
+	assert(0 == llist_mergeSort(pooled));
+	assert(0 == llist_compact(pooled, NULL, 0));
+	assert(nodeStride(pooled) > 0);
+	for (i = 0; i < 100; i++) {
+		assert(llist_popTail(pooled) != NULL);
+		assert(0 == llist_insertTail(pooled, &values[i]));
+	}
+
+	/* Express lanes still lead to the right Nodes */
+	assert(0 == llist_compact(ordered, NULL, 0));
+	cursor = llistCursor_new();
+	assert(0 == llist_lowerBound(ordered, cursor, &values[250]));
+	assert(llistCursor_getData(ordered, cursor) == &values[250]);
+	assert(llist_popNode(ordered, cursor) == &values[250]);
+	assert(0 == llist_lowerBound(ordered, cursor, &values[250]));
+	assert(llistCursor_getData(ordered, cursor) == &values[251]);
+	llistCursor_destroy(&cursor);
+
+	/* A list becoming pooled can't give Nodes to its former siblings anymore,
+	 * lists sharing a pool still can */
+	{
+		LinkedList *sibling = llist_new(NULL, cmpFunc);
+		LinkedList *split;
+
+		assert(0 == llist_insertTail(epochs, &values[0]));
+		assert(0 == llist_insertTail(epochs, &values[1]));
+		assert(0 == llist_insertTail(sibling, &values[2]));
+		assert(0 == llist_concat(epochs, sibling));
+		assert(0 == llist_insertTail(sibling, &values[3]));
+		assert(0 == llist_compact(epochs, NULL, 0));
+		assert(llist_concat(epochs, sibling) == -1 && llist_concat(sibling, epochs) == -1);
+		assert(llist_size(epochs) == 3 && llist_size(sibling) == 1);
+		assert(llist_destroy(&sibling) == 0);
+
+		assert(0 == llistCursor_seek(epochs, cursors[0], 1));
+		split = llist_splitAt(epochs, cursors[0]);
+		assert(split != NULL);
+		assert(0 == llist_compact(split, NULL, 0));
+		assert(0 == llist_compact(epochs, NULL, 0));
+		assert(0 == llist_concat(epochs, split));
+		assert(llist_size(epochs) == 3 && llist_getTailData(epochs) == &values[2]);
+		assert(llist_destroy(&split) == 0);
+	}
+
+	assert(0 == llist_enableEpochs(epochs));
+	assert(llist_compact(epochs, NULL, 0) == -2);
+
+	for (i = 0; i < 3; i++) {
+		llistCursor_destroy(&cursors[i]);
+	}
+	assert(llist_destroy(&epochs) == 0);
+	assert(llist_destroy(&ordered) == 0);
+	assert(llist_destroy(&pooled) == 0);
+	assert(llist_destroy(&plain) == 0);
+}
+
+
+/* Every int collides */
+static size_t
+constantHash(void *data) {
+	(void)data;
+	return 42;
+}
+
+
+void
+testGroupBy(void) {
+	int values[] = { 5, 3, 5, 1, 3, 5, 9, -1 };
+	static int many[3000];
+	LinkedList *llist = fillInts(llist_new(countDestroy, cmpFunc), values);
+	LinkedList *pooled = llist_newPooled(NULL, cmpFunc, 8);
+	LinkedList **groups;
+	LlistCursor *cursor = llistCursor_new();
+	size_t nbGroups, g;
+	int i;
+
+	/* Groups in order of appearance, keeping the order of their Nodes */
+	assert(0 == llist_groupBy(llist, hashInt, &groups, &nbGroups));
+	assert(nbGroups == 4 && llist_size(llist) == 0);
+	{
+		int expected0[] = { 5, 5, 5, -1 };
+		int expected1[] = { 3, 3, -1 };
+		int expected2[] = { 1, -1 };
+		int expected3[] = { 9, -1 };
+
+		checkInts(groups[0], expected0);
+		checkInts(groups[1], expected1);
+		checkInts(groups[2], expected2);
+		checkInts(groups[3], expected3);
+	}
+	assert(0 == llistCursor_getHead(groups[0], cursor));
+	assert(llistCursor_getData(groups[0], cursor) == &values[0]);
+	assert(0 == llistCursor_getNext(groups[0], cursor));
+	assert(llistCursor_getData(groups[0], cursor) == &values[2]);
+	assert(0 == llistCursor_getNext(groups[0], cursor));
+	assert(llistCursor_getData(groups[0], cursor) == &values[5]);
+
+	/* Groups can go back together */
+	for (g = 1; g < nbGroups; g++) {
+		assert(0 == llist_concat(llist, groups[g]));
+		assert(llist_destroy(&groups[g]) == 0);
+	}
+	assert(0 == llist_concat(llist, groups[0]));
+	assert(llist_destroy(&groups[0]) == 0);
+	free(groups);
+	{
+		int expected[] = { 3, 3, 1, 9, 5, 5, 5, -1 };
+
+		checkInts(llist, expected);
+	}
+
+	/* Dedup keeps the first of each */
+	nbDestroyed = 0;
+	assert(0 == llist_uniqueUnordered(llist, hashInt));
+	{
+		int expected[] = { 3, 1, 9, 5, -1 };
+
+		checkInts(llist, expected);
+	}
+	assert(nbDestroyed == 3);
+	assert(0 == llist_insertHead(llist, &values[6]));
+	assert(0 == llist_uniqueUnordered(llist, constantHash));
+	assert(llist_getHeadData(llist) == &values[6] && llist_size(llist) == 4 && nbDestroyed == 4);
+
+	/* Empty, indexed lists */
+	assert(0 == llist_enableIndex(llist, hashInt));
+	assert(llist_uniqueUnordered(llist, hashInt) == -1);
+	assert(llist_groupBy(llist, hashInt, &groups, &nbGroups) == -1 && groups == NULL && nbGroups == 0);
+	assert(llist_destroy(&llist) == 0);
+	llist = llist_new(NULL, cmpFunc);
+	assert(0 == llist_uniqueUnordered(llist, hashInt));
+	assert(0 == llist_groupBy(llist, hashInt, &groups, &nbGroups) && groups == NULL && nbGroups == 0);
+	assert(llist_destroy(&llist) == 0);
+
+	/* Many keys, colliding or not, with Node keys and a pool */
+	for (i = 0; i < 3000; i++) {
+		many[i] = i % 101;
+		assert(0 == llist_insertTail(pooled, &many[i]));
+	}
+	assert(0 == llist_setKeyFunc(pooled, exactKey, 1));
+	assert(0 == llist_groupBy(pooled, constantHash, &groups, &nbGroups));
+	assert(nbGroups == 101);
+	for (g = 0; g < nbGroups; g++) {
+		assert(llist_size(groups[g]) == ((g < 3000 % 101) ? 30 : 29));
+		assert(llist_getHeadData(groups[g]) == &many[g]);
+		assert(llist_countMatch(groups[g], &many[g]) == llist_size(groups[g]));
+		assert(0 == llist_concat(pooled, groups[g]));
+		assert(llist_destroy(&groups[g]) == 0);
+	}
+	free(groups);
+	assert(llist_size(pooled) == 3000);
+	assert(0 == llist_uniqueUnordered(pooled, hashInt));
+	assert(llist_size(pooled) == 101 && llist_getTailData(pooled) == &many[100]);
+
+	llistCursor_destroy(&cursor);
+	assert(llist_destroy(&pooled) == 0);
+}
+
+
+#define INT_CMP(a, b) (((a) > (b)) - ((a) < (b)))
+
+LLIST_DECLARE(IntList, int);
+LLIST_DEFINE(IntList, int, INT_CMP);
+
+
+typedef struct {
+	int key;
+	int rank;
+} KeyRank;
+
+static int
+cmpKeyRank(KeyRank a, KeyRank b) {
+	return INT_CMP(a.key, b.key);
+}
+
+LLIST_DECLARE(KeyRankList, KeyRank);
+LLIST_DEFINE(KeyRankList, KeyRank, cmpKeyRank);
+
+
+void
+testTyped(void) {
+	IntList *ints = IntList_new();
+	KeyRankList *pairs = KeyRankList_new();
+	IntListNode *node;
+	KeyRankListNode *pair;
+	unsigned long rand = 99;
+	int value, prev;
+	int i;
+
+	assert(IntList_popHead(ints, &value) == -1);
+	for (i = 0; i < 1000; i++) {
+		rand = rand * 1103515245 + 12345;
+		assert(0 == IntList_insertTail(ints, (int)((rand >> 8) % 100)));
+	}
+	assert(0 == IntList_insertHead(ints, -1));
+	assert(0 == IntList_insertTail(ints, 100));
+	assert(IntList_size(ints) == 1002);
+
+	assert(0 == IntList_mergeSort(ints));
+	assert(IntList_getHead(ints)->data == -1 && IntList_getTail(ints)->data == 100);
+	prev = -1;
+	for (i = 0, node = IntList_getHead(ints); node != NULL; i++, node = node->next) {
+		assert(node->data >= prev);
+		assert(node->prev == NULL || node->prev->next == node);
+		prev = node->data;
+	}
+	assert(i == 1002);
+
+	node = IntList_find(ints, NULL, 50, LLIST_AFTER);
+	assert(node != NULL && node->data == 50 && node->prev->data == 49);
+	assert(IntList_countMatch(ints, 50) > 0);
+	assert(IntList_find(ints, NULL, 1000, LLIST_BEFORE) == NULL);
+
+	/* Insert around a Node and pop it */
+	assert(0 == IntList_insert(ints, node, 1000, LLIST_BEFORE));
+	assert(0 == IntList_insert(ints, node, 2000, LLIST_AFTER));
+	assert(node->prev->data == 1000 && node->next->data == 2000);
+	assert(0 == IntList_pop(ints, node, &value) && value == 50);
+	node = IntList_find(ints, NULL, 1000, LLIST_AFTER);
+	assert(node->next->data == 2000);
+	assert(0 == IntList_popTail(ints, &value) && value == 100);
+	assert(0 == IntList_popHead(ints, NULL));
+	assert(IntList_size(ints) == 1002 + 2 - 3);
+
+	/* Sorting small structs keeps ties in order */
+	for (i = 0; i < 300; i++) {
+		KeyRank item;
+
+		item.key = (300 - i) % 7;
+		item.rank = i;
+		assert(0 == KeyRankList_insertTail(pairs, item));
+	}
+	assert(0 == KeyRankList_mergeSort(pairs));
+	for (pair = KeyRankList_getHead(pairs); pair->next != NULL; pair = pair->next) {
+		assert(pair->data.key < pair->next->data.key
+				|| (pair->data.key == pair->next->data.key && pair->data.rank < pair->next->data.rank));
+	}
+
+	assert(0 == IntList_destroy(&ints) && ints == NULL);
+	assert(0 == KeyRankList_destroy(&pairs));
+}
+
+
+static int nbTraceBegins = 0;
+static int nbTraceEnds = 0;
+
+
+static void
+traceBegin(LlistOp op, LinkedList *llist, size_t ns, void *context) {
+	(void)op, (void)llist, (void)context;
+	assert(ns == 0);
+	nbTraceBegins++;
+}
+
+
+static void
+traceEnd(LlistOp op, LinkedList *llist, size_t ns, void *context) {
+	(void)op, (void)llist, (void)ns;
+	assert(context == &nbTraceEnds);
+	nbTraceEnds++;
+}
+
+
+/* Histograms only fill up when the library is built with LLIST_TRACE (make TRACE=1) */
+void
+testTrace(void) {
+	int data[3] = { 0, 1, 2 };
+	LinkedList *llist = llist_new(NULL, cmpFunc);
+	LlistCursor *cursor = llistCursor_new();
+	LlistLatency latency;
+	size_t nbCalls = 0;
+	int i;
+
+	assert(strcmp(llist_opName(LLIST_OP_POP_HEAD), "popHead") == 0);
+	assert(llist_opName(LLIST_NB_OPS) == NULL);
+	assert(llist_getLatency(LLIST_NB_OPS, &latency) == -1);
+	llist_resetLatency();
+
+#ifdef LLIST_TRACE
+	assert(0 == llist_setTraceHooks(traceBegin, traceEnd, &nbTraceEnds));
+	for (i = 0; i < 3; i++) {
+		assert(0 == llist_insertHead(llist, &data[i]));
+	}
+	assert(0 == llistCursor_getHead(llist, cursor));
+	assert(0 == llistCursor_find(llist, cursor, &data[0], LLIST_AFTER));
+	assert(llist_popHead(llist) == &data[2]);
+	assert(nbTraceBegins == 5 && nbTraceEnds == 5);
+
+	assert(0 == llist_getLatency(LLIST_OP_INSERT_HEAD, &latency));
+	assert(latency.nbCalls == 3);
+	for (i = 0; i < LLIST_LATENCY_BUCKETS; i++) {
+		nbCalls += latency.buckets[i];
+	}
+	assert(nbCalls == 3);
+	assert(0 == llist_getLatency(LLIST_OP_FIND, &latency) && latency.nbCalls == 1);
+	assert(0 == llist_getLatency(LLIST_OP_SEEK, &latency) && latency.nbCalls == 0);
+
+	{
+		FILE *out = tmpfile();
+		char line[128];
+		int nbLines = 0;
+
+		assert(out != NULL);
+		assert(0 == llist_dumpLatency(out));
+		rewind(out);
+		while (fgets(line, sizeof (line), out) != NULL) {
+			nbLines++;
+		}
+		/* Header, insertHead, popHead and find */
+		assert(nbLines == 4);
+		fclose(out);
+	}
+
+	llist_resetLatency();
+	assert(0 == llist_getLatency(LLIST_OP_INSERT_HEAD, &latency) && latency.nbCalls == 0);
+	assert(0 == llist_setTraceHooks(NULL, NULL, NULL));
+#else
+	assert(llist_setTraceHooks(traceBegin, traceEnd, &nbTraceEnds) == -2);
+	for (i = 0; i < 3; i++) {
+		assert(0 == llist_insertHead(llist, &data[i]));
+	}
+	assert(llist_getLatency(LLIST_OP_INSERT_HEAD, &latency) == -2 && latency.nbCalls == 0);
+	assert(llist_dumpLatency(stdout) == -2);
+	assert(nbTraceBegins == 0 && nbTraceEnds == 0 && nbCalls == 0);
+#endif
+
+	llistCursor_destroy(&cursor);
+	assert(llist_destroy(&llist) == 0);
+}
+
+
 void
 printListFromCursor(LinkedList *llist, LlistCursor *cursor) {
 	int ret;
@@ -103,5 +2471,74 @@ main(void) {
 		assert(llist_destroy(&llist) == 0);
 	}
 
+	testMergeSort();
+	printf("Mergesort OK\n");
+
+	testPooled();
+	printf("Pooled list OK\n");
+
+	testAllocator();
+	printf("Custom allocators OK\n");
+
+	testSizeAndSeek();
+	printf("Size and seek OK\n");
+
+	testUnrolled();
+	printf("Unrolled list OK\n");
+
+	testIntrusive();
+	printf("Intrusive list OK\n");
+
+	testSplice();
+	printf("Splice OK\n");
+
+	testIndex();
+	printf("Index OK\n");
+
+	testOrdered();
+	printf("Ordered list OK\n");
+
+	testConcurrentQueue();
+	printf("Concurrent queue OK\n");
+
+	testConcurrentList();
+	printf("Concurrent list OK\n");
+
+	testEpochs();
+	printf("Epochs OK\n");
+
+	testParallelSort();
+	printf("Parallel sort OK\n");
+
+	testBulk();
+	printf("Bulk traversals OK\n");
+
+	testStats();
+	printf("Stats OK\n");
+
+	testTrace();
+	printf("Tracing OK\n");
+
+	testKeys();
+	printf("Keys OK\n");
+
+	testTyped();
+	printf("Typed lists OK\n");
+
+	testCompact();
+	printf("Compaction OK\n");
+
+	testSortByKey();
+	printf("Sort by key OK\n");
+
+	testMergeSorted();
+	printf("Sorted merges OK\n");
+
+	testSetOps();
+	printf("Set operations OK\n");
+
+	testGroupBy();
+	printf("Group by OK\n");
+
 	return 0;
 }
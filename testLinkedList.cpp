@@ -0,0 +1,239 @@
+/*
+ * Tests of the C++ wrapper (LinkedList.hpp), the C API is tested by testLinkedList.c
+ */
+
+#include <cassert>
+#include <cstdio>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "LinkedList.hpp"
+
+
+/* Counts live instances to check that every element gets destroyed */
+struct Tracked {
+	static int nbAlive;
+
+	int value;
+	std::string name;
+
+	Tracked(int v, const std::string &n) : value(v), name(n) { nbAlive++; }
+	Tracked(const Tracked &other) : value(other.value), name(other.name) { nbAlive++; }
+	Tracked(Tracked &&other) : value(other.value), name(std::move(other.name)) { nbAlive++; }
+	~Tracked() { nbAlive--; }
+
+	bool operator<(const Tracked &other) const { return value < other.value; }
+};
+
+int Tracked::nbAlive = 0;
+
+
+/* Neither < nor == */
+struct Unordered {
+	int value = 0;
+};
+
+
+/* Stateful allocator, copies share their count */
+template <class T>
+struct CountingAlloc {
+	typedef T value_type;
+
+	std::shared_ptr<long> nbLive;
+
+	CountingAlloc() : nbLive(std::make_shared<long>(0)) {}
+	template <class U>
+	CountingAlloc(const CountingAlloc<U> &other) : nbLive(other.nbLive) {}
+
+	T *
+	allocate(std::size_t n) {
+		++*nbLive;
+		return static_cast<T *>(::operator new(n * sizeof (T)));
+	}
+
+	void
+	deallocate(T *p, std::size_t) {
+		--*nbLive;
+		::operator delete(p);
+	}
+
+	template <class U>
+	bool operator==(const CountingAlloc<U> &other) const { return nbLive == other.nbLive; }
+	template <class U>
+	bool operator!=(const CountingAlloc<U> &other) const { return nbLive != other.nbLive; }
+};
+
+
+static void
+testIterators(void) {
+	llist::list<int> ints;
+	std::vector<int> expected;
+	int i;
+
+	assert(ints.empty() && ints.begin() == ints.end());
+	for (i = 0; i < 100; i++) {
+		ints.push_back(i);
+		expected.push_back(i);
+	}
+	ints.push_front(-1);
+	expected.insert(expected.begin(), -1);
+
+	assert(ints.size() == 101 && ints.front() == -1 && ints.back() == 99);
+	assert(std::equal(ints.begin(), ints.end(), expected.begin()));
+	assert(std::equal(ints.rbegin(), ints.rend(), expected.rbegin()));
+	assert(std::accumulate(ints.cbegin(), ints.cend(), 0) == 99 * 100 / 2 - 1);
+
+	llist::list<int>::iterator it = std::find(ints.begin(), ints.end(), 50);
+	assert(it != ints.end() && *it == 50);
+	*it = 500;
+	it = ints.erase(it);
+	assert(*it == 51 && *--it == 49);
+	it = ints.insert(++it, 50);
+	assert(*it == 50 && ints.size() == 101);
+
+	llist::list<int>::const_iterator cit = ints.end();
+	--cit;
+	assert(*cit == 99);
+
+	ints.erase(ints.begin(), std::find(ints.begin(), ints.end(), 10));
+	assert(ints.front() == 10 && ints.size() == 90);
+	ints.pop_front();
+	ints.pop_back();
+	assert(ints.front() == 11 && ints.back() == 98);
+}
+
+
+static void
+testOwnership(void) {
+	{
+		llist::list<Tracked> items;
+
+		items.emplace_back(3, "three");
+		items.emplace_front(1, "one");
+		items.emplace(++items.begin(), 2, "two");
+		items.push_back(Tracked(4, "four"));
+		assert(Tracked::nbAlive == 4);
+		assert(items.begin()->name == "one" && (++items.begin())->name == "two");
+
+		llist::list<Tracked> moved(std::move(items));
+		assert(Tracked::nbAlive == 4 && moved.size() == 4);
+
+		llist::list<Tracked> assigned;
+		assigned.emplace_back(0, "zero");
+		assigned = std::move(moved);
+		assert(Tracked::nbAlive == 4 && assigned.back().name == "four");
+
+		assigned.pop_front();
+		assert(Tracked::nbAlive == 3);
+	}
+	assert(Tracked::nbAlive == 0);
+}
+
+
+static void
+testSortAndSplice(void) {
+	llist::list<Tracked> items;
+	llist::list<Tracked> others;
+	unsigned long rand = 5;
+	int i;
+
+	for (i = 0; i < 1000; i++) {
+		rand = rand * 1103515245 + 12345;
+		items.emplace_back((int)((rand >> 8) % 50), std::to_string(i));
+	}
+	items.sort();
+	assert(std::is_sorted(items.begin(), items.end()));
+
+	/* Stable: equal values keep their insertion order */
+	items.sort([](const Tracked &a, const Tracked &b) { return b.value < a.value; });
+	for (llist::list<Tracked>::iterator it = items.begin(); std::next(it) != items.end(); ++it) {
+		assert(it->value >= std::next(it)->value);
+		if (it->value == std::next(it)->value) {
+			assert(std::stoi(it->name) < std::stoi(std::next(it)->name));
+		}
+	}
+
+	/* The C searches on native() compare with operator< */
+	{
+		Tracked probe(7, "probe");
+		LlistCursor cursor = NULL;
+
+		assert(llist_countMatch(items.native(), &probe)
+				== (size_t)std::count_if(items.begin(), items.end(), [](const Tracked &t) { return t.value == 7; }));
+		assert(0 == llistCursor_getHead(items.native(), &cursor));
+		assert(0 == llistCursor_find(items.native(), &cursor, &probe, LLIST_AFTER));
+		assert(static_cast<Tracked *>(llistCursor_getData(items.native(), &cursor))->value == 7);
+	}
+	{
+		llist::list<std::pair<int, int> > pairs;
+		llist::list<Unordered> unordered;
+		std::pair<int, int> probe(1, 2);
+		Unordered other;
+
+		pairs.emplace_back(1, 2);
+		pairs.emplace_back(1, 3);
+		assert(llist_countMatch(pairs.native(), &probe) == 1);
+		unordered.emplace_back();
+		assert(llist_countMatch(unordered.native(), &other) == 0);
+	}
+
+	/* Splices relink Nodes, nothing gets copied */
+	others.emplace_back(-1, "a");
+	others.emplace_back(-2, "b");
+	others.emplace_back(-3, "c");
+	items.splice(items.begin(), others, std::next(others.begin()), others.end());
+	assert(items.front().name == "b" && (++items.begin())->name == "c" && others.size() == 1);
+	items.splice(items.end(), others);
+	assert(items.back().name == "a" && others.empty() && items.size() == 1003);
+	others.splice(others.end(), items, items.begin());
+	assert(others.front().name == "b" && items.front().name == "c");
+	assert(Tracked::nbAlive == 1003);
+}
+
+
+static void
+testAllocator(void) {
+	CountingAlloc<int> alloc;
+	CountingAlloc<int> copy(alloc);
+
+	{
+		llist::list<int, CountingAlloc<int> > ints(alloc);
+		llist::list<int, CountingAlloc<int> > others(copy);
+		int i;
+
+		for (i = 0; i < 10; i++) {
+			ints.push_back(i);
+			others.push_back(10 + i);
+		}
+		/* Values, Nodes and the lists themselves */
+		assert(*alloc.nbLive == 2 * (10 + 10 + 1));
+
+		/* Stateful allocators don't share Nodes, values move one by one */
+		ints.splice(ints.end(), others, others.begin(), std::next(others.begin(), 5));
+		assert(ints.size() == 15 && others.size() == 5 && ints.back() == 14);
+	}
+	assert(*alloc.nbLive == 0);
+}
+
+
+int
+main(void) {
+	testIterators();
+	printf("C++ iterators OK\n");
+
+	testOwnership();
+	printf("C++ ownership OK\n");
+
+	testSortAndSplice();
+	printf("C++ sort and splice OK\n");
+
+	testAllocator();
+	printf("C++ allocators OK\n");
+
+	return 0;
+}